@@ -45,7 +45,7 @@ char _alDebug[256];
 ///////////////////////////////////////////////////////
 
 
-#define EmptyFuncs { NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL }
+#define EmptyFuncs { NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL }
 static struct {
     const char *name;
     void (*Init)(BackendFuncs*);
@@ -136,6 +136,8 @@ static ALenums enumeration[]={
     { (ALchar *)"ALC_CAPTURE_DEVICE_SPECIFIER",         ALC_CAPTURE_DEVICE_SPECIFIER        },
     { (ALchar *)"ALC_CAPTURE_DEFAULT_DEVICE_SPECIFIER", ALC_CAPTURE_DEFAULT_DEVICE_SPECIFIER},
     { (ALchar *)"ALC_CAPTURE_SAMPLES",                  ALC_CAPTURE_SAMPLES                 },
+    { (ALchar *)"ALC_CAPTURE_LATENCY_EXT",              ALC_CAPTURE_LATENCY_EXT             },
+    { (ALchar *)"ALC_CAPTURE_OVERRUNS_EXT",             ALC_CAPTURE_OVERRUNS_EXT            },
 
     // EFX Properties
     { (ALchar *)"ALC_EFX_MAJOR_VERSION",                ALC_EFX_MAJOR_VERSION               },
@@ -169,7 +171,7 @@ static ALCchar *alcDefaultAllDeviceSpecifier = alcAllDeviceList;
 static ALCchar *alcCaptureDefaultDeviceSpecifier = alcCaptureDeviceList;
 
 
-static ALCchar alcExtensionList[] = "ALC_ENUMERATE_ALL_EXT ALC_ENUMERATION_EXT ALC_EXT_CAPTURE ALC_EXT_EFX";
+static ALCchar alcExtensionList[] = "ALC_ENUMERATE_ALL_EXT ALC_ENUMERATION_EXT ALC_EXT_CAPTURE ALC_EXT_capture_stats ALC_EXT_EFX";
 static ALCint alcMajorVersion = 1;
 static ALCint alcMinorVersion = 1;
 
@@ -211,6 +213,7 @@ static void InitAL(void)
         InitializeCriticalSection(&_alMutex);
         ALTHUNK_INIT();
         ReadALConfig();
+        aluInitPanning();
 
         devs = GetConfigValue(NULL, "drivers", "");
         if(devs[0])
@@ -260,6 +263,12 @@ static void InitAL(void)
                            strcasecmp(str, "yes") == 0 ||
                            strcasecmp(str, "on") == 0 ||
                            atoi(str) != 0);
+
+        str = GetConfigValue(NULL, "float_clamp", "false");
+        ClampFloatOutput = (strcasecmp(str, "true") == 0 ||
+                            strcasecmp(str, "yes") == 0 ||
+                            strcasecmp(str, "on") == 0 ||
+                            atoi(str) != 0);
     }
 }
 
@@ -395,7 +404,13 @@ static ALvoid InitContext(ALCcontext *pContext)
     pContext->lNumStereoSources = 1;
     pContext->lNumMonoSources = pContext->Device->MaxNoOfSources - pContext->lNumStereoSources;
 
-    strcpy(pContext->ExtensionList, "AL_EXT_EXPONENT_DISTANCE AL_EXT_FLOAT32 AL_EXT_IMA4 AL_EXT_LINEAR_DISTANCE AL_EXT_MCFORMATS AL_EXT_OFFSET AL_LOKI_quadriphonic");
+    pContext->VoiceCullGain = GetConfigValueFloat(NULL, "cull_gain", 0.00003f);
+
+    pContext->GridCellSize = GetConfigValueFloat(NULL, "grid_cell_size", 0.0f);
+    if(pContext->GridCellSize > 0.0f && pContext->VoiceCullGain > 0.0f)
+        pContext->SourceGrid = calloc(GRID_BUCKETS, sizeof(*pContext->SourceGrid));
+
+    strcpy(pContext->ExtensionList, "AL_EXT_EXPONENT_DISTANCE AL_EXT_FLOAT32 AL_EXT_IMA4 AL_EXT_LINEAR_DISTANCE AL_EXT_MCFORMATS AL_EXT_OFFSET AL_LOKI_quadriphonic AL_SOFTX_source_priority");
 
     level = GetConfigValueInt(NULL, "cf_level", 0);
     if(level > 0 && level <= 6)
@@ -420,6 +435,13 @@ static ALCvoid ExitContext(ALCcontext *pContext)
 
     free(pContext->bs2b);
     pContext->bs2b = NULL;
+
+    free(pContext->VoiceList);
+    pContext->VoiceList = NULL;
+    pContext->VoiceListSize = 0;
+
+    free(pContext->SourceGrid);
+    pContext->SourceGrid = NULL;
 }
 
 ///////////////////////////////////////////////////////
@@ -571,12 +593,21 @@ ALCAPI ALCvoid ALCAPIENTRY alcSuspendContext(ALCcontext *pContext)
 /*
     alcProcessContext
 
-    Not functional
+    Renders the next update of the context's device when it renders offline,
+    so the output only depends on the calls made between renders. Devices
+    playing in real time render on their own, and nothing happens for them.
 */
 ALCAPI ALCvoid ALCAPIENTRY alcProcessContext(ALCcontext *pContext)
 {
-    // Not a lot happens here !
-    (void)pContext;
+    ALCdevice *device = NULL;
+
+    SuspendContext(NULL);
+    if(IsContext(pContext))
+        device = pContext->Device;
+    ProcessContext(NULL);
+
+    if(device && device->Offline)
+        ALCdevice_ProcessPlayback(device);
 }
 
 
@@ -683,6 +714,20 @@ ALCAPI ALCvoid ALCAPIENTRY alcGetIntegerv(ALCdevice *device,ALCenum param,ALsize
                 SetALCError(ALC_INVALID_VALUE);
             break;
 
+        case ALC_CAPTURE_LATENCY_EXT:
+            if ((size) && (data))
+                *data = ALCdevice_AvailableSamples(device) + device->CaptureDelay;
+            else
+                SetALCError(ALC_INVALID_VALUE);
+            break;
+
+        case ALC_CAPTURE_OVERRUNS_EXT:
+            if ((size) && (data))
+                *data = device->CaptureOverruns;
+            else
+                SetALCError(ALC_INVALID_VALUE);
+            break;
+
         default:
             SetALCError(ALC_INVALID_ENUM);
             break;
@@ -729,7 +774,7 @@ ALCAPI ALCvoid ALCAPIENTRY alcGetIntegerv(ALCdevice *device,ALCenum param,ALsize
                     if(!size)
                         SetALCError(ALC_INVALID_VALUE);
                     else
-                        *data = MAX_SENDS;
+                        *data = (device ? device->NumAuxSends : MAX_SENDS);
                     break;
 
                 case ALC_ATTRIBUTES_SIZE:
@@ -769,7 +814,7 @@ ALCAPI ALCvoid ALCAPIENTRY alcGetIntegerv(ALCdevice *device,ALCenum param,ALsize
                             data[i++] = device->Context->lNumStereoSources;
 
                             data[i++] = ALC_MAX_AUXILIARY_SENDS;
-                            data[i++] = MAX_SENDS;
+                            data[i++] = device->NumAuxSends;
                         }
                         ProcessContext(NULL);
 
@@ -1180,12 +1225,28 @@ ALCAPI ALCdevice* ALCAPIENTRY alcOpenDevice(const ALCchar *deviceName)
         if((ALint)device->MaxNoOfSources <= 0)
             device->MaxNoOfSources = 256;
 
+        device->MaxVoices = GetConfigValueInt(NULL, "maxvoices", 0);
+        if((ALint)device->MaxVoices < 0)
+            device->MaxVoices = 0;
+
+        device->NumAuxSends = GetConfigValueInt(NULL, "sends", 2);
+        if((ALint)device->NumAuxSends <= 0)
+            device->NumAuxSends = 1;
+        device->NumAuxSends = min(device->NumAuxSends, MAX_SENDS);
+
         // Find a playback device to open
         for(i = 0;BackendList[i].Init;i++)
         {
             device->Funcs = &BackendList[i].Funcs;
             if(ALCdevice_OpenPlayback(device, deviceName))
             {
+                // The render queue needs the format and update size the
+                // backend settled on
+                ALint updates = GetConfigValueInt(NULL, "mix_ahead", 0);
+                if(updates > 0 && !device->Offline &&
+                   !StartRenderQueue(device, updates))
+                    AL_PRINT("Could not start mixing ahead, mixing inline\n");
+
                 SuspendContext(NULL);
                 device->next = g_pDeviceList;
                 g_pDeviceList = device;
@@ -1235,6 +1296,7 @@ ALCAPI ALCboolean ALCAPIENTRY alcCloseDevice(ALCdevice *pDevice)
         if(pDevice->Context)
             alcDestroyContext(pDevice->Context);
         ALCdevice_ClosePlayback(pDevice);
+        StopRenderQueue(pDevice);
 
         //Release device structure
         memset(pDevice, 0, sizeof(ALCdevice));
@@ -23,6 +23,10 @@
 #include "config.h"
 
 #include <math.h>
+#include <stdlib.h>
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
 #include "alMain.h"
 #include "AL/al.h"
 #include "AL/alc.h"
@@ -44,16 +48,17 @@ typedef long ALint64;
 typedef long long ALint64;
 #endif
 
-#ifdef HAVE_SQRTF
-#define aluSqrt(x) ((ALfloat)sqrtf((float)(x)))
+#if defined(HAVE_XMMINTRIN_H) && (defined(__SSE__) || defined(_M_X64) || \
+                                   (defined(_M_IX86_FP) && _M_IX86_FP >= 1))
+#include <xmmintrin.h>
+#define HAVE_SSE_CSR
+/* Flush-to-zero, and denormals-are-zero, which every x86-64 CPU has but
+ * some SSE2-era 32-bit ones fault on */
+#if defined(__x86_64__) || defined(_M_X64)
+#define SSE_CSR_FLUSH (0x8000 | 0x0040)
 #else
-#define aluSqrt(x) ((ALfloat)sqrt((double)(x)))
+#define SSE_CSR_FLUSH (0x8000)
 #endif
-
-#ifdef HAVE_ACOSF
-#define aluAcos(x) ((ALfloat)acosf((float)(x)))
-#else
-#define aluAcos(x) ((ALfloat)acos((double)(x)))
 #endif
 
 // fixes for mingw32.
@@ -64,25 +69,12 @@ typedef long long ALint64;
 #define __min min
 #endif
 
-#define BUFFERSIZE 48000
 #define FRACTIONBITS 14
 #define FRACTIONMASK ((1L<<FRACTIONBITS)-1)
 #define MAX_PITCH 4
 
-enum {
-    FRONT_LEFT = 0,
-    FRONT_RIGHT,
-    SIDE_LEFT,
-    SIDE_RIGHT,
-    BACK_LEFT,
-    BACK_RIGHT,
-    CENTER,
-    LFE,
-
-    OUTPUTCHANNELS
-};
-
 ALboolean DuplicateStereo = AL_FALSE;
+ALboolean ClampFloatOutput = AL_FALSE;
 
 /* NOTE: The AL_FORMAT_REAR* enums aren't handled here be cause they're
  *       converted to AL_FORMAT_QUAD* when loaded */
@@ -163,14 +155,15 @@ __inline ALuint aluChannelsFromFormat(ALenum format)
 }
 
 
+/* Constant-power panning gains, filled in by aluInitPanning */
+ALfloat aluPanTable[PANTABLE_SIZE+1];
+
 static __inline ALshort aluF2S(ALfloat Value)
 {
-    ALint i;
-
-    i = (ALint)Value;
-    i = __min( 32767, i);
-    i = __max(-32768, i);
-    return ((ALshort)i);
+    // Clamp before converting, since out of range values don't convert
+    Value = __min(Value,  32767.0f);
+    Value = __max(Value, -32768.0f);
+    return ((ALshort)Value);
 }
 
 static __inline ALvoid aluCrossproduct(ALfloat *inVector1,ALfloat *inVector2,ALfloat *outVector)
@@ -200,51 +193,334 @@ static __inline ALvoid aluNormalize(ALfloat *inVector)
     }
 }
 
-static __inline ALvoid aluMatrixVector(ALfloat *vector,ALfloat matrix[3][3])
+/* Shelf filter coefficients from the Audio EQ Cookbook, with a slope of 1.
+ * Returns AL_FALSE when the gain leaves the filter flat, so the stage can be
+ * skipped. */
+static ALboolean aluCalcShelf(ALbiquad *f, ALboolean HighShelf, ALfloat gain,
+                              ALfloat cw, ALfloat alpha)
+{
+    ALfloat A, sqrtA2, a0;
+
+    if(gain >= 0.9999f)
+        return AL_FALSE;
+    gain = __max(gain, 0.0001f);
+
+    A = aluSqrt(gain);
+    sqrtA2 = 2.0f * aluSqrt(A) * alpha;
+    if(HighShelf)
+    {
+        a0    =          (A+1.0f) - (A-1.0f)*cw + sqrtA2;
+        f->a1 =  2.0f*  ((A-1.0f) - (A+1.0f)*cw);
+        f->a2 =          (A+1.0f) - (A-1.0f)*cw - sqrtA2;
+        f->b0 =     A*  ((A+1.0f) + (A-1.0f)*cw + sqrtA2);
+        f->b1 = -2.0f*A*((A-1.0f) + (A+1.0f)*cw);
+        f->b2 =     A*  ((A+1.0f) + (A-1.0f)*cw - sqrtA2);
+    }
+    else
+    {
+        a0    =          (A+1.0f) + (A-1.0f)*cw + sqrtA2;
+        f->a1 = -2.0f*  ((A-1.0f) + (A+1.0f)*cw);
+        f->a2 =          (A+1.0f) + (A-1.0f)*cw - sqrtA2;
+        f->b0 =     A*  ((A+1.0f) - (A-1.0f)*cw + sqrtA2);
+        f->b1 =  2.0f*A*((A-1.0f) - (A+1.0f)*cw);
+        f->b2 =     A*  ((A+1.0f) - (A-1.0f)*cw - sqrtA2);
+    }
+    f->a1 /= a0; f->a2 /= a0;
+    f->b0 /= a0; f->b1 /= a0; f->b2 /= a0;
+
+    return AL_TRUE;
+}
+
+static int VoiceRankCompare(const void *a, const void *b)
+{
+    const ALsource *s1 = *(const ALsource*const*)a;
+    const ALsource *s2 = *(const ALsource*const*)b;
+
+    if(s1->Priority != s2->Priority)
+        return (s1->Priority > s2->Priority) ? -1 : 1;
+    if(s1->Audibility != s2->Audibility)
+        return (s1->Audibility > s2->Audibility) ? -1 : 1;
+    if(s1->source != s2->source)
+        return (s1->source < s2->source) ? -1 : 1;
+    return 0;
+}
+
+/* Returns whether a playing source ends up virtual regardless of the voice
+ * limit, being out of the grid's range or below the cull gain, or has nothing
+ * to mix */
+static ALboolean IsSourceCulled(ALCcontext *ALContext, ALsource *ALSource)
 {
-    ALfloat result[3];
+    ALbuffer *ALBuffer;
+
+    if(!ALSource->ulBufferID)
+        return AL_TRUE;
 
-    result[0] = vector[0]*matrix[0][0] + vector[1]*matrix[1][0] + vector[2]*matrix[2][0];
-    result[1] = vector[0]*matrix[0][1] + vector[1]*matrix[1][1] + vector[2]*matrix[2][1];
-    result[2] = vector[0]*matrix[0][2] + vector[1]*matrix[1][2] + vector[2]*matrix[2][2];
-    memcpy(vector, result, sizeof(result));
+    ALBuffer = (ALbuffer*)ALTHUNK_LOOKUPENTRY(ALSource->ulBufferID);
+    if(aluChannelsFromFormat(ALBuffer->format) == 1 && ALSource->InGrid &&
+       ALSource->GridStamp != ALContext->GridStamp)
+        return AL_TRUE;
+    return (ALSource->Audibility < ALContext->VoiceCullGain);
 }
 
-static __inline ALfloat aluComputeSample(ALfloat GainHF, ALfloat sample, ALfloat LastSample)
+/* Marks the playing sources that don't fit in the device's voice limit.
+ * Only sources that would otherwise be mixed take a voice. They're ranked by
+ * priority, then by their audibility for this update, then by name, so the
+ * outcome only depends on source state. */
+static ALvoid LimitVoices(ALCcontext *ALContext)
 {
-    if(GainHF < 1.0f)
+    ALuint MaxVoices = ALContext->Device->MaxVoices;
+    ALsource *ALSource;
+    ALuint count, i;
+
+    count = 0;
+    for(ALSource = ALContext->Source;ALSource;ALSource = ALSource->next)
     {
-        if(GainHF > 0.0f)
+        ALSource->VoiceLimited = AL_FALSE;
+        if(ALSource->state == AL_PLAYING && !IsSourceCulled(ALContext, ALSource))
+            count++;
+    }
+    if(MaxVoices == 0 || count <= MaxVoices)
+        return;
+
+    // alGenSources keeps the list big enough for every source
+    if(count > ALContext->VoiceListSize)
+        return;
+
+    count = 0;
+    for(ALSource = ALContext->Source;ALSource;ALSource = ALSource->next)
+    {
+        if(ALSource->state == AL_PLAYING && !IsSourceCulled(ALContext, ALSource))
+            ALContext->VoiceList[count++] = ALSource;
+    }
+    qsort(ALContext->VoiceList, count, sizeof(ALsource*), VoiceRankCompare);
+
+    for(i = MaxVoices;i < count;i++)
+        ALContext->VoiceList[i]->VoiceLimited = AL_TRUE;
+}
+
+static __inline ALvoid StampIfInRange(ALsource *ALSource, const ALfloat *Listener,
+                                      ALuint Stamp)
+{
+    ALfloat dx = ALSource->vPosition[0] - Listener[0];
+    ALfloat dy = ALSource->vPosition[1] - Listener[1];
+    ALfloat dz = ALSource->vPosition[2] - Listener[2];
+
+    if(dx*dx + dy*dy + dz*dz <= ALSource->CullRadius*ALSource->CullRadius)
+        ALSource->GridStamp = Stamp;
+}
+
+/* Stamps the sources in the grid that are within their cull radius of the
+ * listener. Only the cells within the largest cull radius are visited, unless
+ * there are more of those than hash buckets, in which case every bucket is. */
+static ALvoid QuerySourceGrid(ALCcontext *ALContext)
+{
+    ALfloat *Listener = ALContext->Listener.Position;
+    ALfloat CellSize = ALContext->GridCellSize;
+    ALsource *ALSource;
+    ALint lo[3], hi[3];
+    ALint x, y, z;
+    ALdouble cells;
+    ALuint i;
+
+    ALContext->GridStamp++;
+
+    if(ALContext->GridMaxDirty)
+    {
+        ALContext->GridMaxRadius = 0.0f;
+        for(i = 0;i < GRID_BUCKETS;i++)
         {
-            sample *= GainHF;
-            sample += LastSample * (1.0f-GainHF);
+            for(ALSource = ALContext->SourceGrid[i];ALSource;ALSource = ALSource->GridNext)
+                ALContext->GridMaxRadius = __max(ALContext->GridMaxRadius, ALSource->CullRadius);
         }
-        else
-            sample = 0.0f;
+        ALContext->GridMaxDirty = AL_FALSE;
+    }
+
+    cells = 1.0;
+    for(i = 0;i < 3;i++)
+    {
+        lo[i] = GetGridCoord(Listener[i]-ALContext->GridMaxRadius, CellSize);
+        hi[i] = GetGridCoord(Listener[i]+ALContext->GridMaxRadius, CellSize);
+        cells *= (ALdouble)hi[i] - lo[i] + 1.0;
     }
 
-    return sample;
+    if(cells > GRID_BUCKETS)
+    {
+        for(i = 0;i < GRID_BUCKETS;i++)
+        {
+            for(ALSource = ALContext->SourceGrid[i];ALSource;ALSource = ALSource->GridNext)
+                StampIfInRange(ALSource, Listener, ALContext->GridStamp);
+        }
+        return;
+    }
+
+    for(z = lo[2];z <= hi[2];z++)
+    {
+        for(y = lo[1];y <= hi[1];y++)
+        {
+            for(x = lo[0];x <= hi[0];x++)
+            {
+                ALSource = ALContext->SourceGrid[GRID_HASH(x, y, z)];
+                for(;ALSource;ALSource = ALSource->GridNext)
+                {
+                    if(ALSource->GridCell[0] == x && ALSource->GridCell[1] == y &&
+                       ALSource->GridCell[2] == z)
+                        StampIfInRange(ALSource, Listener, ALContext->GridStamp);
+                }
+            }
+        }
+    }
 }
 
-static ALvoid CalcSourceParams(ALCcontext *ALContext, ALsource *ALSource,
-                               ALenum isMono, ALenum OutputFormat,
-                               ALfloat *drysend, ALfloat *wetsend,
-                               ALfloat *pitch, ALfloat *drygainhf,
-                               ALfloat *wetgainhf)
+/* Positional sources have their parameters calculated in batches. The inputs
+ * of every source in a batch are gathered into arrays, each step of the
+ * calculation runs as a loop over the whole batch, and the results are
+ * scattered back to the sources' Params. With SSE2, the distance, cone
+ * vector, doppler and rotation steps run four sources per vector, with
+ * masked selects standing in for the branches. They take the same steps as
+ * the plain loops, which finish off the batch, so every source gets the same
+ * result either way. */
+#define PARAM_BATCH 64
+
+typedef struct {
+    ALsource *Source[PARAM_BATCH];
+    ALuint    Count;
+
+    ALfloat PosX[PARAM_BATCH], PosY[PARAM_BATCH], PosZ[PARAM_BATCH];
+    ALfloat DirX[PARAM_BATCH], DirY[PARAM_BATCH], DirZ[PARAM_BATCH];
+    ALfloat VelX[PARAM_BATCH], VelY[PARAM_BATCH], VelZ[PARAM_BATCH];
+    ALfloat ToLisX[PARAM_BATCH], ToLisY[PARAM_BATCH], ToLisZ[PARAM_BATCH];
+    ALfloat MinDist[PARAM_BATCH], MaxDist[PARAM_BATCH];
+    ALfloat Rolloff[PARAM_BATCH], RoomRolloff[MAX_SENDS][PARAM_BATCH];
+    ALfloat Distance[PARAM_BATCH];
+    ALfloat CosAngle[PARAM_BATCH];
+    ALfloat Pitch[PARAM_BATCH];
+    ALfloat Attenuation[PARAM_BATCH];
+    ALfloat RoomAttenuation[MAX_SENDS][PARAM_BATCH];
+    ALfloat ConeVolume[PARAM_BATCH];
+    ALfloat DryMix[PARAM_BATCH], WetMix[MAX_SENDS][PARAM_BATCH];
+    ALfloat DryGainHF[PARAM_BATCH], WetGainHF[MAX_SENDS][PARAM_BATCH];
+    ALfloat DryGainLF[PARAM_BATCH], WetGainLF[MAX_SENDS][PARAM_BATCH];
+    ALfloat Pan[OUTPUTCHANNELS][PARAM_BATCH];
+
+    // Cosine and alpha of the shelf frequencies, indexed by filter stage
+    ALfloat ShelfCos[2], ShelfAlpha[2];
+} ALparambatch;
+
+static ALparambatch ParamBatch;
+
+#ifdef HAVE_SSE2
+// Picks a where the mask is set, and b where it isn't
+static __inline __m128 aluSelect4(__m128 mask, __m128 a, __m128 b)
+{
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+// Length of four vectors, summed in the same order as the plain code
+static __inline __m128 aluLength4(__m128 x, __m128 y, __m128 z)
+{
+    return _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)),
+                                  _mm_mul_ps(z, z)));
+}
+
+static __inline __m128 aluDotproduct4(__m128 x1, __m128 y1, __m128 z1,
+                                      __m128 x2, __m128 y2, __m128 z2)
+{
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(x1, x2), _mm_mul_ps(y1, y2)),
+                      _mm_mul_ps(z1, z2));
+}
+#endif
+
+static ALvoid CalcShelfParams(ALCcontext *ALContext, ALparambatch *B)
+{
+    static const ALfloat ShelfFreq[2] = { LOWPASS_FREQUENCY, HIGHPASS_FREQUENCY };
+    ALfloat w0;
+    ALuint f;
+
+    for(f = 0;f < 2;f++)
+    {
+        w0 = __min(ShelfFreq[f], ALContext->Frequency*0.45f);
+        w0 = 2.0f*3.14159265358979323846f * w0 / ALContext->Frequency;
+        B->ShelfCos[f] = (ALfloat)cos(w0);
+        B->ShelfAlpha[f] = (ALfloat)sin(w0) / 2.0f * aluSqrt(2.0f);
+    }
+}
+
+/* Sets up one biquad stage of a path. A stage that was off has its history
+ * cleared as it turns on, so it doesn't start from a stale state. */
+static ALvoid aluUpdateFilterStage(const ALparambatch *B, ALuint stage, ALfloat gain,
+                                   ALbiquad *f, ALboolean *on,
+                                   ALfloat *state, ALuint statesize)
+{
+    ALboolean WasOn = *on;
+
+    *on = aluCalcShelf(f, (stage == FILTER_HF), gain, B->ShelfCos[stage],
+                       B->ShelfAlpha[stage]);
+    if(*on && !WasOn)
+        memset(state, 0, statesize);
+}
+
+static ALvoid CalcNonAttnSourceParams(ALCcontext *ALContext, ALparambatch *B,
+                                      ALsource *ALSource)
+{
+    ALfloat Gain = ALSource->flGain * ALContext->Listener.Gain;
+    ALfloat GainHF = 1.0f, GainLF = 1.0f;
+    ALuint i;
+
+    //Multi-channel buffers always play "normal", but still go through the
+    //direct filter
+    switch(ALSource->DirectFilter.type)
+    {
+        case AL_FILTER_LOWPASS:
+            Gain *= ALSource->DirectFilter.Gain;
+            GainHF = ALSource->DirectFilter.GainHF;
+            break;
+        case AL_FILTER_HIGHPASS:
+            Gain *= ALSource->DirectFilter.Gain;
+            GainLF = ALSource->DirectFilter.GainLF;
+            break;
+        case AL_FILTER_BANDPASS:
+            Gain *= ALSource->DirectFilter.Gain;
+            GainHF = ALSource->DirectFilter.GainHF;
+            GainLF = ALSource->DirectFilter.GainLF;
+            break;
+    }
+
+    ALSource->Params.Pitch = ALSource->flPitch;
+    for(i = 0;i < OUTPUTCHANNELS;i++)
+        ALSource->Params.DrySend[i] = Gain;
+    aluUpdateFilterStage(B, FILTER_HF, GainHF,
+                         &ALSource->Params.DryFilter[FILTER_HF],
+                         &ALSource->Params.DryFilterOn[FILTER_HF],
+                         ALSource->DryFilterState[FILTER_HF][0],
+                         sizeof(ALSource->DryFilterState[FILTER_HF]));
+    aluUpdateFilterStage(B, FILTER_LF, GainLF,
+                         &ALSource->Params.DryFilter[FILTER_LF],
+                         &ALSource->Params.DryFilterOn[FILTER_LF],
+                         ALSource->DryFilterState[FILTER_LF][0],
+                         sizeof(ALSource->DryFilterState[FILTER_LF]));
+    for(i = 0;i < MAX_SENDS;i++)
+    {
+        ALSource->Params.Send[i].WetGain = 0.0f;
+        ALSource->Params.Send[i].WetFilterOn[FILTER_HF] = AL_FALSE;
+        ALSource->Params.Send[i].WetFilterOn[FILTER_LF] = AL_FALSE;
+    }
+    ALSource->Audibility = Gain * OUTPUTCHANNELS;
+}
+
+static ALvoid CalcSourceParamsBatch(ALCcontext *ALContext, ALparambatch *B,
+                                    ALenum OutputFormat)
 {
-    ALfloat InnerAngle,OuterAngle,Angle,Distance,DryMix,WetMix=0.0f;
-    ALfloat Direction[3],Position[3],SourceToListener[3];
-    ALfloat MinVolume,MaxVolume,MinDist,MaxDist,Rolloff,OuterGainHF;
-    ALfloat ConeVolume,SourceVolume,PanningFB,PanningLR,ListenerGain;
-    ALfloat U[3],V[3],N[3];
     ALfloat DopplerFactor, DopplerVelocity, flSpeedOfSound, flMaxVelocity;
+    ALfloat U[3],V[3],N[3];
     ALfloat Matrix[3][3];
-    ALfloat flAttenuation;
-    ALfloat RoomAttenuation;
-    ALfloat MetersPerUnit;
-    ALfloat RoomRolloff;
-    ALfloat DryGainHF = 1.0f;
-    ALfloat WetGainHF = 1.0f;
+    ALfloat ListenerGain, MetersPerUnit;
+    ALfloat PanningFB, PanningLR;
+    ALenum DistanceModel = ALContext->DistanceModel;
+    ALuint NumSends = ALContext->Device->NumAuxSends;
+    ALuint Count = B->Count;
+    ALsource *ALSource;
+    ALeffectslot *Slot;
+    ALuint i, c, s;
 
     //Get context properties
     DopplerFactor   = ALContext->DopplerFactor;
@@ -255,43 +531,146 @@ static ALvoid CalcSourceParams(ALCcontext *ALContext, ALsource *ALSource,
     ListenerGain = ALContext->Listener.Gain;
     MetersPerUnit = ALContext->Listener.MetersPerUnit;
 
-    //Get source properties
-    SourceVolume = ALSource->flGain;
-    memcpy(Position,  ALSource->vPosition,    sizeof(ALSource->vPosition));
-    memcpy(Direction, ALSource->vOrientation, sizeof(ALSource->vOrientation));
-    MinVolume    = ALSource->flMinGain;
-    MaxVolume    = ALSource->flMaxGain;
-    MinDist      = ALSource->flRefDistance;
-    MaxDist      = ALSource->flMaxDistance;
-    Rolloff      = ALSource->flRollOffFactor;
-    InnerAngle   = ALSource->flInnerAngle;
-    OuterAngle   = ALSource->flOuterAngle;
-    OuterGainHF  = ALSource->OuterGainHF;
-    RoomRolloff  = ALSource->RoomRolloffFactor;
-
-    //Only apply 3D calculations for mono buffers
-    if(isMono != AL_FALSE)
+    //1. Translate Listener to origin (convert to head relative)
+    for(i = 0;i < Count;i++)
     {
-        //1. Translate Listener to origin (convert to head relative)
+        ALSource = B->Source[i];
+        B->PosX[i] = ALSource->vPosition[0];
+        B->PosY[i] = ALSource->vPosition[1];
+        B->PosZ[i] = ALSource->vPosition[2];
         if(ALSource->bHeadRelative==AL_FALSE)
         {
-            Position[0] -= ALContext->Listener.Position[0];
-            Position[1] -= ALContext->Listener.Position[1];
-            Position[2] -= ALContext->Listener.Position[2];
+            B->PosX[i] -= ALContext->Listener.Position[0];
+            B->PosY[i] -= ALContext->Listener.Position[1];
+            B->PosZ[i] -= ALContext->Listener.Position[2];
         }
+        B->DirX[i] = ALSource->vOrientation[0];
+        B->DirY[i] = ALSource->vOrientation[1];
+        B->DirZ[i] = ALSource->vOrientation[2];
+        B->VelX[i] = ALSource->vVelocity[0];
+        B->VelY[i] = ALSource->vVelocity[1];
+        B->VelZ[i] = ALSource->vVelocity[2];
+
+        B->MinDist[i] = ALSource->flRefDistance;
+        B->MaxDist[i] = ALSource->flMaxDistance;
+        B->Rolloff[i] = ALSource->flRollOffFactor;
+        for(s = 0;s < NumSends;s++)
+        {
+            B->RoomRolloff[s][i] = ALSource->RoomRolloffFactor;
+            Slot = ALSource->Send[s].Slot;
+            if(Slot && !Slot->AuxSendAuto && Slot->effect.type == AL_EFFECT_REVERB)
+                B->RoomRolloff[s][i] = Slot->effect.Reverb.RoomRolloffFactor;
+        }
+        B->Pitch[i] = ALSource->flPitch;
+    }
 
-        //2. Calculate distance attenuation
-        Distance = aluSqrt(aluDotproduct(Position, Position));
-
-        if(ALSource->Send[0].Slot && !ALSource->Send[0].Slot->AuxSendAuto)
+    //2. Calculate distance attenuation
+    i = 0;
+#ifdef HAVE_SSE2
+    for(;i+4 <= Count;i += 4)
+    {
+        const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f);
+        __m128 MinDist = _mm_loadu_ps(&B->MinDist[i]);
+        __m128 MaxDist = _mm_loadu_ps(&B->MaxDist[i]);
+        __m128 Rolloff = _mm_loadu_ps(&B->Rolloff[i]);
+        __m128 RoomRolloff, Distance, Valid, Delta, Denom;
+
+        Distance = aluLength4(_mm_loadu_ps(&B->PosX[i]), _mm_loadu_ps(&B->PosY[i]),
+                              _mm_loadu_ps(&B->PosZ[i]));
+        // Lanes whose model is out of range keep an attenuation of 1
+        Valid = _mm_cmpeq_ps(one, one);
+        _mm_storeu_ps(&B->Attenuation[i], one);
+        for(s = 0;s < NumSends;s++)
+            _mm_storeu_ps(&B->RoomAttenuation[s][i], one);
+
+        switch(DistanceModel)
         {
-            if(ALSource->Send[0].Slot->effect.type == AL_EFFECT_REVERB)
-                RoomRolloff = ALSource->Send[0].Slot->effect.Reverb.RoomRolloffFactor;
+            case AL_INVERSE_DISTANCE_CLAMPED:
+                Distance = _mm_min_ps(_mm_max_ps(Distance, MinDist), MaxDist);
+                Valid = _mm_cmpge_ps(MaxDist, MinDist);
+                //fall-through
+            case AL_INVERSE_DISTANCE:
+                Valid = _mm_and_ps(Valid, _mm_cmpgt_ps(MinDist, zero));
+                Delta = _mm_sub_ps(Distance, MinDist);
+                Denom = _mm_add_ps(MinDist, _mm_mul_ps(Rolloff, Delta));
+                _mm_storeu_ps(&B->Attenuation[i],
+                              aluSelect4(_mm_and_ps(Valid, _mm_cmpgt_ps(Denom, zero)),
+                                         _mm_div_ps(MinDist, Denom), one));
+                for(s = 0;s < NumSends;s++)
+                {
+                    RoomRolloff = _mm_loadu_ps(&B->RoomRolloff[s][i]);
+                    Denom = _mm_add_ps(MinDist, _mm_mul_ps(RoomRolloff, Delta));
+                    _mm_storeu_ps(&B->RoomAttenuation[s][i],
+                                  aluSelect4(_mm_and_ps(Valid, _mm_cmpgt_ps(Denom, zero)),
+                                             _mm_div_ps(MinDist, Denom), one));
+                }
+                break;
+
+            case AL_LINEAR_DISTANCE_CLAMPED:
+                Distance = _mm_min_ps(_mm_max_ps(Distance, MinDist), MaxDist);
+                Valid = _mm_cmpge_ps(MaxDist, MinDist);
+                //fall-through
+            case AL_LINEAR_DISTANCE:
+                Distance = _mm_min_ps(Distance, MaxDist);
+                Valid = _mm_and_ps(Valid, _mm_cmpneq_ps(MaxDist, MinDist));
+                Delta = _mm_sub_ps(Distance, MinDist);
+                Denom = _mm_sub_ps(MaxDist, MinDist);
+                _mm_storeu_ps(&B->Attenuation[i],
+                              aluSelect4(Valid, _mm_sub_ps(one, _mm_div_ps(_mm_mul_ps(Rolloff, Delta),
+                                                                           Denom)), one));
+                for(s = 0;s < NumSends;s++)
+                {
+                    RoomRolloff = _mm_loadu_ps(&B->RoomRolloff[s][i]);
+                    _mm_storeu_ps(&B->RoomAttenuation[s][i],
+                                  aluSelect4(Valid, _mm_sub_ps(one, _mm_div_ps(_mm_mul_ps(RoomRolloff, Delta),
+                                                                               Denom)), one));
+                }
+                break;
+
+            case AL_EXPONENT_DISTANCE_CLAMPED:
+                Distance = _mm_min_ps(_mm_max_ps(Distance, MinDist), MaxDist);
+                Valid = _mm_cmpge_ps(MaxDist, MinDist);
+                //fall-through
+            case AL_EXPONENT_DISTANCE:
+                Valid = _mm_and_ps(Valid, _mm_and_ps(_mm_cmpgt_ps(Distance, zero),
+                                                     _mm_cmpgt_ps(MinDist, zero)));
+                // Rolloffs are negated by flipping the sign bit
+                Delta = _mm_div_ps(Distance, MinDist);
+                _mm_storeu_ps(&B->Attenuation[i],
+                              aluSelect4(Valid, aluFastPow4(Delta, _mm_xor_ps(Rolloff, _mm_set1_ps(-0.0f))),
+                                         one));
+                for(s = 0;s < NumSends;s++)
+                {
+                    RoomRolloff = _mm_loadu_ps(&B->RoomRolloff[s][i]);
+                    _mm_storeu_ps(&B->RoomAttenuation[s][i],
+                                  aluSelect4(Valid, aluFastPow4(Delta, _mm_xor_ps(RoomRolloff,
+                                                                                  _mm_set1_ps(-0.0f))),
+                                             one));
+                }
+                break;
+
+            case AL_NONE:
+            default:
+                break;
         }
+        _mm_storeu_ps(&B->Distance[i], Distance);
+    }
+#endif
+    for(;i < Count;i++)
+    {
+        ALfloat MinDist, MaxDist, Rolloff, Distance;
+
+        MinDist     = B->MinDist[i];
+        MaxDist     = B->MaxDist[i];
+        Rolloff     = B->Rolloff[i];
+        Distance    = aluSqrt(B->PosX[i]*B->PosX[i] + B->PosY[i]*B->PosY[i] +
+                              B->PosZ[i]*B->PosZ[i]);
+
+        B->Attenuation[i] = 1.0f;
+        for(s = 0;s < NumSends;s++)
+            B->RoomAttenuation[s][i] = 1.0f;
 
-        flAttenuation = 1.0f;
-        RoomAttenuation = 1.0f;
-        switch (ALContext->DistanceModel)
+        switch(DistanceModel)
         {
             case AL_INVERSE_DISTANCE_CLAMPED:
                 Distance=__max(Distance,MinDist);
@@ -303,9 +682,12 @@ static ALvoid CalcSourceParams(ALCcontext *ALContext, ALsource *ALSource,
                 if (MinDist > 0.0f)
                 {
                     if ((MinDist + (Rolloff * (Distance - MinDist))) > 0.0f)
-                        flAttenuation = MinDist / (MinDist + (Rolloff * (Distance - MinDist)));
-                    if ((MinDist + (RoomRolloff * (Distance - MinDist))) > 0.0f)
-                        RoomAttenuation = MinDist / (MinDist + (RoomRolloff * (Distance - MinDist)));
+                        B->Attenuation[i] = MinDist / (MinDist + (Rolloff * (Distance - MinDist)));
+                    for(s = 0;s < NumSends;s++)
+                    {
+                        if ((MinDist + (B->RoomRolloff[s][i] * (Distance - MinDist))) > 0.0f)
+                            B->RoomAttenuation[s][i] = MinDist / (MinDist + (B->RoomRolloff[s][i] * (Distance - MinDist)));
+                    }
                 }
                 break;
 
@@ -319,8 +701,9 @@ static ALvoid CalcSourceParams(ALCcontext *ALContext, ALsource *ALSource,
                 Distance=__min(Distance,MaxDist);
                 if (MaxDist != MinDist)
                 {
-                    flAttenuation = 1.0f - (Rolloff*(Distance-MinDist)/(MaxDist - MinDist));
-                    RoomAttenuation = 1.0f - (RoomRolloff*(Distance-MinDist)/(MaxDist - MinDist));
+                    B->Attenuation[i] = 1.0f - (Rolloff*(Distance-MinDist)/(MaxDist - MinDist));
+                    for(s = 0;s < NumSends;s++)
+                        B->RoomAttenuation[s][i] = 1.0f - (B->RoomRolloff[s][i]*(Distance-MinDist)/(MaxDist - MinDist));
                 }
                 break;
 
@@ -333,70 +716,173 @@ static ALvoid CalcSourceParams(ALCcontext *ALContext, ALsource *ALSource,
             case AL_EXPONENT_DISTANCE:
                 if ((Distance > 0.0f) && (MinDist > 0.0f))
                 {
-                    flAttenuation = (ALfloat)pow(Distance/MinDist, -Rolloff);
-                    RoomAttenuation = (ALfloat)pow(Distance/MinDist, -RoomRolloff);
+                    B->Attenuation[i] = aluFastPow(Distance/MinDist, -Rolloff);
+                    for(s = 0;s < NumSends;s++)
+                        B->RoomAttenuation[s][i] = aluFastPow(Distance/MinDist, -B->RoomRolloff[s][i]);
                 }
                 break;
 
             case AL_NONE:
             default:
-                flAttenuation = 1.0f;
-                RoomAttenuation = 1.0f;
                 break;
         }
+        B->Distance[i] = Distance;
+    }
 
-        // Source Gain + Attenuation and clamp to Min/Max Gain
-        DryMix = SourceVolume * flAttenuation;
-        DryMix = __min(DryMix,MaxVolume);
-        DryMix = __max(DryMix,MinVolume);
-
-        WetMix = SourceVolume * (ALSource->WetGainAuto ?
-                                 RoomAttenuation : 1.0f);
-        WetMix = __min(WetMix,MaxVolume);
-        WetMix = __max(WetMix,MinVolume);
-
-        //3. Apply directional soundcones
-        SourceToListener[0] = -Position[0];
-        SourceToListener[1] = -Position[1];
-        SourceToListener[2] = -Position[2];
-        aluNormalize(Direction);
-        aluNormalize(SourceToListener);
-        Angle = aluAcos(aluDotproduct(Direction,SourceToListener)) * 180.0f /
-                3.141592654f;
-        if(Angle >= InnerAngle && Angle <= OuterAngle)
+    // Source Gain + Attenuation and clamp to Min/Max Gain
+    for(i = 0;i < Count;i++)
+    {
+        ALSource = B->Source[i];
+        B->DryMix[i] = ALSource->flGain * B->Attenuation[i];
+        B->DryMix[i] = __min(B->DryMix[i],ALSource->flMaxGain);
+        B->DryMix[i] = __max(B->DryMix[i],ALSource->flMinGain);
+
+        for(s = 0;s < NumSends;s++)
         {
-            ALfloat scale = (Angle-InnerAngle) / (OuterAngle-InnerAngle);
-            ConeVolume = (1.0f+(ALSource->flOuterGain-1.0f)*scale);
-            if(ALSource->WetGainAuto)
-                WetMix *= ConeVolume;
-            if(ALSource->DryGainHFAuto)
-                DryGainHF *= (1.0f+(OuterGainHF-1.0f)*scale);
-            if(ALSource->WetGainHFAuto)
-                WetGainHF *= (1.0f+(OuterGainHF-1.0f)*scale);
+            B->WetMix[s][i] = ALSource->flGain * (ALSource->WetGainAuto ?
+                                                  B->RoomAttenuation[s][i] : 1.0f);
+            B->WetMix[s][i] = __min(B->WetMix[s][i],ALSource->flMaxGain);
+            B->WetMix[s][i] = __max(B->WetMix[s][i],ALSource->flMinGain);
+            B->WetGainHF[s][i] = 1.0f;
+            B->WetGainLF[s][i] = 1.0f;
         }
-        else if(Angle > OuterAngle)
+
+        B->DryGainHF[i] = 1.0f;
+        B->DryGainLF[i] = 1.0f;
+    }
+
+    //3. Apply directional soundcones
+    i = 0;
+#ifdef HAVE_SSE2
+    for(;i+4 <= Count;i += 4)
+    {
+        const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f);
+        const __m128 negone = _mm_set1_ps(-1.0f);
+        __m128 dx, dy, dz, x, y, z, len;
+
+        dx = _mm_loadu_ps(&B->DirX[i]);
+        dy = _mm_loadu_ps(&B->DirY[i]);
+        dz = _mm_loadu_ps(&B->DirZ[i]);
+        len = aluLength4(dx, dy, dz);
+        len = aluSelect4(_mm_cmpneq_ps(len, zero), _mm_div_ps(one, len), one);
+        dx = _mm_mul_ps(dx, len);
+        dy = _mm_mul_ps(dy, len);
+        dz = _mm_mul_ps(dz, len);
+        _mm_storeu_ps(&B->DirX[i], dx);
+        _mm_storeu_ps(&B->DirY[i], dy);
+        _mm_storeu_ps(&B->DirZ[i], dz);
+
+        x = _mm_loadu_ps(&B->PosX[i]);
+        y = _mm_loadu_ps(&B->PosY[i]);
+        z = _mm_loadu_ps(&B->PosZ[i]);
+        len = aluLength4(x, y, z);
+        len = aluSelect4(_mm_cmpneq_ps(len, zero), _mm_div_ps(negone, len), negone);
+        x = _mm_mul_ps(x, len);
+        y = _mm_mul_ps(y, len);
+        z = _mm_mul_ps(z, len);
+        _mm_storeu_ps(&B->ToLisX[i], x);
+        _mm_storeu_ps(&B->ToLisY[i], y);
+        _mm_storeu_ps(&B->ToLisZ[i], z);
+
+        _mm_storeu_ps(&B->CosAngle[i], aluDotproduct4(dx, dy, dz, x, y, z));
+    }
+#endif
+    for(;i < Count;i++)
+    {
+        ALfloat len;
+
+        len = aluSqrt(B->DirX[i]*B->DirX[i] + B->DirY[i]*B->DirY[i] +
+                      B->DirZ[i]*B->DirZ[i]);
+        len = ((len != 0.0f) ? 1.0f/len : 1.0f);
+        B->DirX[i] *= len;
+        B->DirY[i] *= len;
+        B->DirZ[i] *= len;
+
+        len = aluSqrt(B->PosX[i]*B->PosX[i] + B->PosY[i]*B->PosY[i] +
+                      B->PosZ[i]*B->PosZ[i]);
+        len = ((len != 0.0f) ? -1.0f/len : -1.0f);
+        B->ToLisX[i] = B->PosX[i] * len;
+        B->ToLisY[i] = B->PosY[i] * len;
+        B->ToLisZ[i] = B->PosZ[i] * len;
+
+        B->CosAngle[i] = B->DirX[i]*B->ToLisX[i] + B->DirY[i]*B->ToLisY[i] +
+                         B->DirZ[i]*B->ToLisZ[i];
+    }
+
+    for(i = 0;i < Count;i++)
+    {
+        ALfloat CosInner, CosOuter, OuterGainHF, ConeHF, scale;
+
+        ALSource = B->Source[i];
+        CosInner    = ALSource->CosInnerAngle;
+        CosOuter    = ALSource->CosOuterAngle;
+        OuterGainHF = ALSource->OuterGainHF;
+
+        //Compare cosines, so only sources between the inner and outer cone
+        //need the angle
+        scale = aluConeScale(B->CosAngle[i], CosInner, CosOuter,
+                             ALSource->flInnerAngle, ALSource->flOuterAngle);
+        B->ConeVolume[i] = (1.0f+(ALSource->flOuterGain-1.0f)*scale);
+        ConeHF = (1.0f+(OuterGainHF-1.0f)*scale);
+
+        if(ALSource->DryGainHFAuto)
+            B->DryGainHF[i] *= ConeHF;
+        for(s = 0;s < NumSends;s++)
         {
-            ConeVolume = (1.0f+(ALSource->flOuterGain-1.0f));
             if(ALSource->WetGainAuto)
-                WetMix *= ConeVolume;
-            if(ALSource->DryGainHFAuto)
-                DryGainHF *= (1.0f+(OuterGainHF-1.0f));
+                B->WetMix[s][i] *= B->ConeVolume[i];
             if(ALSource->WetGainHFAuto)
-                WetGainHF *= (1.0f+(OuterGainHF-1.0f));
+                B->WetGainHF[s][i] *= ConeHF;
         }
-        else
-            ConeVolume = 1.0f;
+    }
 
-        //4. Calculate Velocity
-        if(DopplerFactor != 0.0f)
+    //4. Calculate Velocity
+    if(DopplerFactor != 0.0f)
+    {
+        flMaxVelocity = (DopplerVelocity * flSpeedOfSound) / DopplerFactor;
+
+        i = 0;
+#ifdef HAVE_SSE2
+        for(;i+4 <= Count;i += 4)
+        {
+            const __m128 MaxVel = _mm_set1_ps(flMaxVelocity);
+            const __m128 MinVel = _mm_set1_ps(-flMaxVelocity);
+            const __m128 MaxClamp = _mm_set1_ps(flMaxVelocity - 1.0f);
+            const __m128 MinClamp = _mm_set1_ps(-flMaxVelocity + 1.0f);
+            const __m128 SoundVel = _mm_set1_ps(flSpeedOfSound * DopplerVelocity);
+            const __m128 Factor = _mm_set1_ps(DopplerFactor);
+            __m128 x, y, z, VSS, VLS;
+
+            x = _mm_loadu_ps(&B->ToLisX[i]);
+            y = _mm_loadu_ps(&B->ToLisY[i]);
+            z = _mm_loadu_ps(&B->ToLisZ[i]);
+            VLS = aluDotproduct4(_mm_set1_ps(ALContext->Listener.Velocity[0]),
+                                 _mm_set1_ps(ALContext->Listener.Velocity[1]),
+                                 _mm_set1_ps(ALContext->Listener.Velocity[2]),
+                                 x, y, z);
+            VSS = aluDotproduct4(_mm_loadu_ps(&B->VelX[i]), _mm_loadu_ps(&B->VelY[i]),
+                                 _mm_loadu_ps(&B->VelZ[i]), x, y, z);
+
+            VSS = aluSelect4(_mm_cmpge_ps(VSS, MaxVel), MaxClamp,
+                             aluSelect4(_mm_cmple_ps(VSS, MinVel), MinClamp, VSS));
+            VLS = aluSelect4(_mm_cmpge_ps(VLS, MaxVel), MaxClamp,
+                             aluSelect4(_mm_cmple_ps(VLS, MinVel), MinClamp, VLS));
+
+            _mm_storeu_ps(&B->Pitch[i],
+                          _mm_div_ps(_mm_mul_ps(_mm_loadu_ps(&B->Pitch[i]),
+                                                _mm_sub_ps(SoundVel, _mm_mul_ps(Factor, VLS))),
+                                     _mm_sub_ps(SoundVel, _mm_mul_ps(Factor, VSS))));
+        }
+#endif
+        for(;i < Count;i++)
         {
             ALfloat flVSS, flVLS;
 
-            flVLS = aluDotproduct(ALContext->Listener.Velocity,
-                                  SourceToListener);
-            flVSS = aluDotproduct(ALSource->vVelocity, SourceToListener);
-
-            flMaxVelocity = (DopplerVelocity * flSpeedOfSound) / DopplerFactor;
+            flVLS = ALContext->Listener.Velocity[0]*B->ToLisX[i] +
+                    ALContext->Listener.Velocity[1]*B->ToLisY[i] +
+                    ALContext->Listener.Velocity[2]*B->ToLisZ[i];
+            flVSS = B->VelX[i]*B->ToLisX[i] + B->VelY[i]*B->ToLisY[i] +
+                    B->VelZ[i]*B->ToLisZ[i];
 
             if (flVSS >= flMaxVelocity)
                 flVSS = (flMaxVelocity - 1.0f);
@@ -408,189 +894,562 @@ static ALvoid CalcSourceParams(ALCcontext *ALContext, ALsource *ALSource,
             else if (flVLS <= -flMaxVelocity)
                 flVLS = -flMaxVelocity + 1.0f;
 
-            pitch[0] = ALSource->flPitch *
+            B->Pitch[i] = B->Pitch[i] *
                        ((flSpeedOfSound * DopplerVelocity) - (DopplerFactor * flVLS)) /
                        ((flSpeedOfSound * DopplerVelocity) - (DopplerFactor * flVSS));
         }
-        else
-            pitch[0] = ALSource->flPitch;
-
-        //5. Align coordinate system axes
-        aluCrossproduct(ALContext->Listener.Forward, ALContext->Listener.Up, U); // Right-vector
-        aluNormalize(U);  // Normalized Right-vector
-        memcpy(V, ALContext->Listener.Up, sizeof(V));   // Up-vector
-        aluNormalize(V);  // Normalized Up-vector
-        memcpy(N, ALContext->Listener.Forward, sizeof(N));  // At-vector
-        aluNormalize(N);  // Normalized At-vector
-        Matrix[0][0] = U[0]; Matrix[0][1] = V[0]; Matrix[0][2] = -N[0];
-        Matrix[1][0] = U[1]; Matrix[1][1] = V[1]; Matrix[1][2] = -N[1];
-        Matrix[2][0] = U[2]; Matrix[2][1] = V[2]; Matrix[2][2] = -N[2];
-        aluMatrixVector(Position, Matrix);
-
-        //6. Apply filter gains and filters
+    }
+
+    //5. Align coordinate system axes, once for the whole batch
+    aluCrossproduct(ALContext->Listener.Forward, ALContext->Listener.Up, U); // Right-vector
+    aluNormalize(U);  // Normalized Right-vector
+    memcpy(V, ALContext->Listener.Up, sizeof(V));   // Up-vector
+    aluNormalize(V);  // Normalized Up-vector
+    memcpy(N, ALContext->Listener.Forward, sizeof(N));  // At-vector
+    aluNormalize(N);  // Normalized At-vector
+    Matrix[0][0] = U[0]; Matrix[0][1] = V[0]; Matrix[0][2] = -N[0];
+    Matrix[1][0] = U[1]; Matrix[1][1] = V[1]; Matrix[1][2] = -N[1];
+    Matrix[2][0] = U[2]; Matrix[2][1] = V[2]; Matrix[2][2] = -N[2];
+    i = 0;
+#ifdef HAVE_SSE2
+    for(;i+4 <= Count;i += 4)
+    {
+        const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f);
+        __m128 x, y, z, rx, ry, rz, len;
+
+        x = _mm_loadu_ps(&B->PosX[i]);
+        y = _mm_loadu_ps(&B->PosY[i]);
+        z = _mm_loadu_ps(&B->PosZ[i]);
+        rx = aluDotproduct4(x, y, z, _mm_set1_ps(Matrix[0][0]), _mm_set1_ps(Matrix[1][0]),
+                            _mm_set1_ps(Matrix[2][0]));
+        ry = aluDotproduct4(x, y, z, _mm_set1_ps(Matrix[0][1]), _mm_set1_ps(Matrix[1][1]),
+                            _mm_set1_ps(Matrix[2][1]));
+        rz = aluDotproduct4(x, y, z, _mm_set1_ps(Matrix[0][2]), _mm_set1_ps(Matrix[1][2]),
+                            _mm_set1_ps(Matrix[2][2]));
+
+        len = aluLength4(rx, ry, rz);
+        len = aluSelect4(_mm_cmpneq_ps(len, zero), _mm_div_ps(one, len), one);
+        _mm_storeu_ps(&B->PosX[i], _mm_mul_ps(rx, len));
+        _mm_storeu_ps(&B->PosY[i], _mm_mul_ps(ry, len));
+        _mm_storeu_ps(&B->PosZ[i], _mm_mul_ps(rz, len));
+    }
+#endif
+    for(;i < Count;i++)
+    {
+        ALfloat x = B->PosX[i], y = B->PosY[i], z = B->PosZ[i];
+        ALfloat len;
+
+        B->PosX[i] = x*Matrix[0][0] + y*Matrix[1][0] + z*Matrix[2][0];
+        B->PosY[i] = x*Matrix[0][1] + y*Matrix[1][1] + z*Matrix[2][1];
+        B->PosZ[i] = x*Matrix[0][2] + y*Matrix[1][2] + z*Matrix[2][2];
+
+        len = aluSqrt(B->PosX[i]*B->PosX[i] + B->PosY[i]*B->PosY[i] +
+                      B->PosZ[i]*B->PosZ[i]);
+        len = ((len != 0.0f) ? 1.0f/len : 1.0f);
+        B->PosX[i] *= len;
+        B->PosY[i] *= len;
+        B->PosZ[i] *= len;
+    }
+
+    //6. Apply filter gains and filters
+    for(i = 0;i < Count;i++)
+    {
+        ALSource = B->Source[i];
+
         switch(ALSource->DirectFilter.type)
         {
             case AL_FILTER_LOWPASS:
-                DryMix *= ALSource->DirectFilter.Gain;
-                DryGainHF *= ALSource->DirectFilter.GainHF;
+                B->DryMix[i] *= ALSource->DirectFilter.Gain;
+                B->DryGainHF[i] *= ALSource->DirectFilter.GainHF;
                 break;
-        }
-
-        switch(ALSource->Send[0].WetFilter.type)
-        {
-            case AL_FILTER_LOWPASS:
-                WetMix *= ALSource->Send[0].WetFilter.Gain;
-                WetGainHF *= ALSource->Send[0].WetFilter.GainHF;
+            case AL_FILTER_HIGHPASS:
+                B->DryMix[i] *= ALSource->DirectFilter.Gain;
+                B->DryGainLF[i] *= ALSource->DirectFilter.GainLF;
+                break;
+            case AL_FILTER_BANDPASS:
+                B->DryMix[i] *= ALSource->DirectFilter.Gain;
+                B->DryGainHF[i] *= ALSource->DirectFilter.GainHF;
+                B->DryGainLF[i] *= ALSource->DirectFilter.GainLF;
                 break;
         }
 
         if(ALSource->AirAbsorptionFactor > 0.0f)
-            DryGainHF *= pow(ALSource->AirAbsorptionFactor * AIRABSORBGAINHF,
-                             Distance * MetersPerUnit);
+            B->DryGainHF[i] *= aluFastPow(ALSource->AirAbsorptionFactor * AIRABSORBGAINHF,
+                                          B->Distance[i] * MetersPerUnit);
 
-        if(ALSource->Send[0].Slot)
+        for(s = 0;s < NumSends;s++)
         {
-            WetMix *= ALSource->Send[0].Slot->Gain;
+            switch(ALSource->Send[s].WetFilter.type)
+            {
+                case AL_FILTER_LOWPASS:
+                    B->WetMix[s][i] *= ALSource->Send[s].WetFilter.Gain;
+                    B->WetGainHF[s][i] *= ALSource->Send[s].WetFilter.GainHF;
+                    break;
+                case AL_FILTER_HIGHPASS:
+                    B->WetMix[s][i] *= ALSource->Send[s].WetFilter.Gain;
+                    B->WetGainLF[s][i] *= ALSource->Send[s].WetFilter.GainLF;
+                    break;
+                case AL_FILTER_BANDPASS:
+                    B->WetMix[s][i] *= ALSource->Send[s].WetFilter.Gain;
+                    B->WetGainHF[s][i] *= ALSource->Send[s].WetFilter.GainHF;
+                    B->WetGainLF[s][i] *= ALSource->Send[s].WetFilter.GainLF;
+                    break;
+            }
 
-            if(ALSource->Send[0].Slot->effect.type == AL_EFFECT_REVERB)
+            Slot = ALSource->Send[s].Slot;
+            if(Slot)
             {
-                WetGainHF *= ALSource->Send[0].Slot->effect.Reverb.GainHF;
-                WetGainHF *= pow(ALSource->Send[0].Slot->effect.Reverb.AirAbsorptionGainHF,
-                                 Distance * MetersPerUnit);
+                B->WetMix[s][i] *= Slot->Gain;
+
+                if(Slot->effect.type == AL_EFFECT_REVERB)
+                {
+                    B->WetGainHF[s][i] *= Slot->effect.Reverb.GainHF;
+                    B->WetGainHF[s][i] *= aluFastPow(Slot->effect.Reverb.AirAbsorptionGainHF,
+                                                     B->Distance[i] * MetersPerUnit);
+                }
+            }
+            else
+            {
+                B->WetMix[s][i] = 0.0f;
+                B->WetGainHF[s][i] = 1.0f;
+                B->WetGainLF[s][i] = 1.0f;
             }
         }
-        else
-        {
-            WetMix = 0.0f;
-            WetGainHF = 1.0f;
-        }
+    }
 
-        DryMix *= ListenerGain * ConeVolume;
-        WetMix *= ListenerGain;
+    for(i = 0;i < Count;i++)
+        B->DryMix[i] *= ListenerGain * B->ConeVolume[i];
+    for(s = 0;s < NumSends;s++)
+    {
+        for(i = 0;i < Count;i++)
+            B->WetMix[s][i] *= ListenerGain;
+    }
 
-        //7. Convert normalized position into pannings, then into channel volumes
-        aluNormalize(Position);
-        switch(aluChannelsFromFormat(OutputFormat))
-        {
-            case 1:
-                drysend[FRONT_LEFT]  = DryMix * aluSqrt(1.0f); //Direct
-                drysend[FRONT_RIGHT] = DryMix * aluSqrt(1.0f); //Direct
-                wetsend[FRONT_LEFT]  = WetMix * aluSqrt(1.0f); //Room
-                wetsend[FRONT_RIGHT] = WetMix * aluSqrt(1.0f); //Room
-                break;
-            case 2:
-                PanningLR = 0.5f + 0.5f*Position[0];
-                drysend[FRONT_LEFT]  = DryMix * aluSqrt(1.0f-PanningLR); //L Direct
-                drysend[FRONT_RIGHT] = DryMix * aluSqrt(     PanningLR); //R Direct
-                wetsend[FRONT_LEFT]  = WetMix * aluSqrt(1.0f-PanningLR); //L Room
-                wetsend[FRONT_RIGHT] = WetMix * aluSqrt(     PanningLR); //R Room
-                break;
-            case 4:
-            /* TODO: Add center/lfe channel in spatial calculations? */
-            case 6:
+    //7. Convert normalized position into pannings, then into channel volumes
+    for(c = 0;c < OUTPUTCHANNELS;c++)
+    {
+        for(i = 0;i < Count;i++)
+            B->Pan[c][i] = 0.0f;
+    }
+    switch(aluChannelsFromFormat(OutputFormat))
+    {
+        case 1:
+            for(i = 0;i < Count;i++)
+            {
+                B->Pan[FRONT_LEFT][i]  = 1.0f; //Direct
+                B->Pan[FRONT_RIGHT][i] = 1.0f; //Direct
+            }
+            break;
+        case 2:
+            for(i = 0;i < Count;i++)
+            {
+                PanningLR = 0.5f + 0.5f*B->PosX[i];
+                B->Pan[FRONT_LEFT][i]  = aluPanGain(1.0f-PanningLR); //L
+                B->Pan[FRONT_RIGHT][i] = aluPanGain(     PanningLR); //R
+            }
+            break;
+        case 4:
+        /* TODO: Add center/lfe channel in spatial calculations? */
+        case 6:
+            for(i = 0;i < Count;i++)
+            {
                 // Apply a scalar so each individual speaker has more weight
-                PanningLR = 0.5f + (0.5f*Position[0]*1.41421356f);
+                PanningLR = 0.5f + (0.5f*B->PosX[i]*1.41421356f);
                 PanningLR = __min(1.0f, PanningLR);
                 PanningLR = __max(0.0f, PanningLR);
-                PanningFB = 0.5f + (0.5f*Position[2]*1.41421356f);
+                PanningFB = 0.5f + (0.5f*B->PosZ[i]*1.41421356f);
                 PanningFB = __min(1.0f, PanningFB);
                 PanningFB = __max(0.0f, PanningFB);
-                drysend[FRONT_LEFT]  = DryMix * aluSqrt((1.0f-PanningLR)*(1.0f-PanningFB));
-                drysend[FRONT_RIGHT] = DryMix * aluSqrt((     PanningLR)*(1.0f-PanningFB));
-                drysend[BACK_LEFT]   = DryMix * aluSqrt((1.0f-PanningLR)*(     PanningFB));
-                drysend[BACK_RIGHT]  = DryMix * aluSqrt((     PanningLR)*(     PanningFB));
-                wetsend[FRONT_LEFT]  = WetMix * aluSqrt((1.0f-PanningLR)*(1.0f-PanningFB));
-                wetsend[FRONT_RIGHT] = WetMix * aluSqrt((     PanningLR)*(1.0f-PanningFB));
-                wetsend[BACK_LEFT]   = WetMix * aluSqrt((1.0f-PanningLR)*(     PanningFB));
-                wetsend[BACK_RIGHT]  = WetMix * aluSqrt((     PanningLR)*(     PanningFB));
-                break;
-            case 7:
-            case 8:
-                PanningFB = 1.0f - fabs(Position[2]*1.15470054f);
+                B->Pan[FRONT_LEFT][i]  = aluPanGain(1.0f-PanningLR)*aluPanGain(1.0f-PanningFB);
+                B->Pan[FRONT_RIGHT][i] = aluPanGain(     PanningLR)*aluPanGain(1.0f-PanningFB);
+                B->Pan[BACK_LEFT][i]   = aluPanGain(1.0f-PanningLR)*aluPanGain(     PanningFB);
+                B->Pan[BACK_RIGHT][i]  = aluPanGain(     PanningLR)*aluPanGain(     PanningFB);
+            }
+            break;
+        case 7:
+        case 8:
+            for(i = 0;i < Count;i++)
+            {
+                ALfloat Front, Side;
+
+                PanningFB = 1.0f - fabs(B->PosZ[i]*1.15470054f);
                 PanningFB = __min(1.0f, PanningFB);
                 PanningFB = __max(0.0f, PanningFB);
-                PanningLR = 0.5f + (0.5*Position[0]*((1.0f-PanningFB)*2.0f));
+                PanningLR = 0.5f + (0.5*B->PosX[i]*((1.0f-PanningFB)*2.0f));
                 PanningLR = __min(1.0f, PanningLR);
                 PanningLR = __max(0.0f, PanningLR);
-                if(Position[2] > 0.0f)
-                {
-                    drysend[BACK_LEFT]   = DryMix * aluSqrt((1.0f-PanningLR)*(1.0f-PanningFB));
-                    drysend[BACK_RIGHT]  = DryMix * aluSqrt((     PanningLR)*(1.0f-PanningFB));
-                    drysend[SIDE_LEFT]   = DryMix * aluSqrt((1.0f-PanningLR)*(     PanningFB));
-                    drysend[SIDE_RIGHT]  = DryMix * aluSqrt((     PanningLR)*(     PanningFB));
-                    drysend[FRONT_LEFT]  = 0.0f;
-                    drysend[FRONT_RIGHT] = 0.0f;
-                    wetsend[BACK_LEFT]   = WetMix * aluSqrt((1.0f-PanningLR)*(1.0f-PanningFB));
-                    wetsend[BACK_RIGHT]  = WetMix * aluSqrt((     PanningLR)*(1.0f-PanningFB));
-                    wetsend[SIDE_LEFT]   = WetMix * aluSqrt((1.0f-PanningLR)*(     PanningFB));
-                    wetsend[SIDE_RIGHT]  = WetMix * aluSqrt((     PanningLR)*(     PanningFB));
-                    wetsend[FRONT_LEFT]  = 0.0f;
-                    wetsend[FRONT_RIGHT] = 0.0f;
-                }
-                else
-                {
-                    drysend[FRONT_LEFT]  = DryMix * aluSqrt((1.0f-PanningLR)*(1.0f-PanningFB));
-                    drysend[FRONT_RIGHT] = DryMix * aluSqrt((     PanningLR)*(1.0f-PanningFB));
-                    drysend[SIDE_LEFT]   = DryMix * aluSqrt((1.0f-PanningLR)*(     PanningFB));
-                    drysend[SIDE_RIGHT]  = DryMix * aluSqrt((     PanningLR)*(     PanningFB));
-                    drysend[BACK_LEFT]   = 0.0f;
-                    drysend[BACK_RIGHT]  = 0.0f;
-                    wetsend[FRONT_LEFT]  = WetMix * aluSqrt((1.0f-PanningLR)*(1.0f-PanningFB));
-                    wetsend[FRONT_RIGHT] = WetMix * aluSqrt((     PanningLR)*(1.0f-PanningFB));
-                    wetsend[SIDE_LEFT]   = WetMix * aluSqrt((1.0f-PanningLR)*(     PanningFB));
-                    wetsend[SIDE_RIGHT]  = WetMix * aluSqrt((     PanningLR)*(     PanningFB));
-                    wetsend[BACK_LEFT]   = 0.0f;
-                    wetsend[BACK_RIGHT]  = 0.0f;
-                }
-            default:
-                break;
+                Front = ((B->PosZ[i] > 0.0f) ? 0.0f : 1.0f);
+                B->Pan[SIDE_LEFT][i]   = aluPanGain(1.0f-PanningLR)*aluPanGain(     PanningFB);
+                B->Pan[SIDE_RIGHT][i]  = aluPanGain(     PanningLR)*aluPanGain(     PanningFB);
+                Side = aluPanGain(1.0f-PanningLR)*aluPanGain(1.0f-PanningFB);
+                B->Pan[FRONT_LEFT][i]  = Side*Front;
+                B->Pan[BACK_LEFT][i]   = Side*(1.0f-Front);
+                Side = aluPanGain(     PanningLR)*aluPanGain(1.0f-PanningFB);
+                B->Pan[FRONT_RIGHT][i] = Side*Front;
+                B->Pan[BACK_RIGHT][i]  = Side*(1.0f-Front);
+            }
+            break;
+        default:
+            break;
+    }
+
+    //8. Scatter the results back to the sources
+    for(i = 0;i < Count;i++)
+    {
+        ALSource = B->Source[i];
+        ALSource->Params.Pitch = B->Pitch[i];
+        ALSource->Audibility = 0.0f;
+        for(c = 0;c < OUTPUTCHANNELS;c++)
+        {
+            ALSource->Params.DrySend[c] = B->DryMix[i] * B->Pan[c][i];
+            ALSource->Audibility += ALSource->Params.DrySend[c];
+        }
+        aluUpdateFilterStage(B, FILTER_HF, B->DryGainHF[i],
+                             &ALSource->Params.DryFilter[FILTER_HF],
+                             &ALSource->Params.DryFilterOn[FILTER_HF],
+                             ALSource->DryFilterState[FILTER_HF][0],
+                             sizeof(ALSource->DryFilterState[FILTER_HF]));
+        aluUpdateFilterStage(B, FILTER_LF, B->DryGainLF[i],
+                             &ALSource->Params.DryFilter[FILTER_LF],
+                             &ALSource->Params.DryFilterOn[FILTER_LF],
+                             ALSource->DryFilterState[FILTER_LF][0],
+                             sizeof(ALSource->DryFilterState[FILTER_LF]));
+
+        //Effect slot inputs are mono, so sends aren't panned
+        for(s = 0;s < NumSends;s++)
+        {
+            ALSource->Params.Send[s].WetGain = B->WetMix[s][i];
+            aluUpdateFilterStage(B, FILTER_HF, B->WetGainHF[s][i],
+                                 &ALSource->Params.Send[s].WetFilter[FILTER_HF],
+                                 &ALSource->Params.Send[s].WetFilterOn[FILTER_HF],
+                                 ALSource->WetFilterState[s][FILTER_HF],
+                                 sizeof(ALSource->WetFilterState[s][FILTER_HF]));
+            aluUpdateFilterStage(B, FILTER_LF, B->WetGainLF[s][i],
+                                 &ALSource->Params.Send[s].WetFilter[FILTER_LF],
+                                 &ALSource->Params.Send[s].WetFilterOn[FILTER_LF],
+                                 ALSource->WetFilterState[s][FILTER_LF],
+                                 sizeof(ALSource->WetFilterState[s][FILTER_LF]));
+            ALSource->Audibility += B->WetMix[s][i];
         }
+        for(;s < MAX_SENDS;s++)
+        {
+            ALSource->Params.Send[s].WetGain = 0.0f;
+            ALSource->Params.Send[s].WetFilterOn[FILTER_HF] = AL_FALSE;
+            ALSource->Params.Send[s].WetFilterOn[FILTER_LF] = AL_FALSE;
+        }
+    }
+}
+
+/* Calculates the parameters of every playing source for this update.
+ * Sources the source grid found out of range are skipped. */
+static ALvoid CalcAllSourceParams(ALCcontext *ALContext, ALenum OutputFormat)
+{
+    ALparambatch *B = &ParamBatch;
+    ALsource *ALSource;
+    ALbuffer *ALBuffer;
+
+    B->Count = 0;
+    CalcShelfParams(ALContext, B);
+    for(ALSource = ALContext->Source;ALSource;ALSource = ALSource->next)
+    {
+        if(ALSource->state != AL_PLAYING || !ALSource->ulBufferID)
+            continue;
+
+        ALBuffer = (ALbuffer*)ALTHUNK_LOOKUPENTRY(ALSource->ulBufferID);
+        ALSource->Params.Channels = aluChannelsFromFormat(ALBuffer->format);
+        if(ALSource->Params.Channels != 1)
+        {
+            CalcNonAttnSourceParams(ALContext, B, ALSource);
+            continue;
+        }
+        if(ALSource->InGrid && ALSource->GridStamp != ALContext->GridStamp)
+        {
+            ALSource->Audibility = 0.0f;
+            continue;
+        }
+
+        B->Source[B->Count++] = ALSource;
+        if(B->Count == PARAM_BATCH)
+        {
+            CalcSourceParamsBatch(ALContext, B, OutputFormat);
+            B->Count = 0;
+        }
+    }
+    if(B->Count > 0)
+        CalcSourceParamsBatch(ALContext, B, OutputFormat);
+    B->Count = 0;
+}
+
+/* Recalculates one source's parameters partway through an update, for when
+ * its queue moves on to a buffer with a different channel count. The shelf
+ * parameters from CalcAllSourceParams are still current. */
+static ALvoid CalcSourceParams(ALCcontext *ALContext, ALsource *ALSource,
+                               ALenum OutputFormat)
+{
+    ALparambatch *B = &ParamBatch;
+    ALbuffer *ALBuffer;
+
+    ALBuffer = (ALbuffer*)ALTHUNK_LOOKUPENTRY(ALSource->ulBufferID);
+    ALSource->Params.Channels = aluChannelsFromFormat(ALBuffer->format);
+    if(ALSource->Params.Channels != 1)
+    {
+        CalcNonAttnSourceParams(ALContext, B, ALSource);
+        return;
+    }
+    if(ALSource->InGrid && ALSource->GridStamp != ALContext->GridStamp)
+    {
+        ALSource->Audibility = 0.0f;
+        return;
+    }
+
+    B->Source[0] = ALSource;
+    B->Count = 1;
+    CalcSourceParamsBatch(ALContext, B, OutputFormat);
+    B->Count = 0;
+}
+
+/* Sources are resampled into a voice buffer a block at a time, which is then
+ * filtered and mixed as a whole */
+#define VOICE_BLOCK 256
+
+/* Output channel of each buffer channel, indexed by the channel count */
+static const ALuint ChannelMap[OUTPUTCHANNELS+1][OUTPUTCHANNELS] = {
+    { 0 }, { 0 },
+    { FRONT_LEFT, FRONT_RIGHT },
+    { 0 },
+    { FRONT_LEFT, FRONT_RIGHT, BACK_LEFT, BACK_RIGHT },
+    { 0 },
+    { FRONT_LEFT, FRONT_RIGHT, CENTER, LFE, BACK_LEFT, BACK_RIGHT },
+    { FRONT_LEFT, FRONT_RIGHT, LFE, BACK_LEFT, BACK_RIGHT, SIDE_LEFT, SIDE_RIGHT },
+    { FRONT_LEFT, FRONT_RIGHT, CENTER, LFE, BACK_LEFT, BACK_RIGHT, SIDE_LEFT, SIDE_RIGHT }
+};
+
+/* Output conversion. Each device format has a channel map, giving the bus
+ * channel that feeds each output channel in order, and a kernel that
+ * converts a run of float samples to the sample type. A chunk of the bus is
+ * gathered through the map into a contiguous run, which the kernel then
+ * converts into the device's buffer. */
+#define CONVERT_CHUNK 256
+
+typedef struct ALoutputlayout {
+    ALenum Format;
+    ALuint Channels;
+    ALuint SampleSize;
+    ALuint Map[OUTPUTCHANNELS];
+    ALvoid (*Convert)(const ALfloat *in, ALvoid *out, ALuint count);
+} ALoutputlayout;
+
+/* Float to signed 16-bit, saturating. Values are truncated like aluF2S. */
+static ALvoid aluConvertS16(const ALfloat *in, ALvoid *outptr, ALuint count)
+{
+    ALshort *out = outptr;
+    ALuint i = 0;
+
+#ifdef HAVE_SSE2
+    const __m128 upper = _mm_set1_ps(32767.0f);
+    const __m128 lower = _mm_set1_ps(-32768.0f);
+
+    for(;i+8 <= count;i += 8)
+    {
+        // Clamp as floats first, since out of range conversions give
+        // 0x80000000, then pack with signed saturation
+        __m128i lo = _mm_cvttps_epi32(_mm_max_ps(_mm_min_ps(_mm_loadu_ps(&in[i]), upper), lower));
+        __m128i hi = _mm_cvttps_epi32(_mm_max_ps(_mm_min_ps(_mm_loadu_ps(&in[i+4]), upper), lower));
+        _mm_storeu_si128((__m128i*)&out[i], _mm_packs_epi32(lo, hi));
+    }
+#endif
+    for(;i < count;i++)
+        out[i] = aluF2S(in[i]);
+}
+
+/* Float to unsigned 8-bit, through 16-bit like the old conversion */
+static ALvoid aluConvertU8(const ALfloat *in, ALvoid *outptr, ALuint count)
+{
+    ALubyte *out = outptr;
+    ALuint i = 0;
+
+#ifdef HAVE_SSE2
+    const __m128 upper = _mm_set1_ps(32767.0f);
+    const __m128 lower = _mm_set1_ps(-32768.0f);
+    const __m128i bias = _mm_set1_epi16(128);
 
-        *drygainhf = DryGainHF;
-        *wetgainhf = WetGainHF;
+    for(;i+16 <= count;i += 16)
+    {
+        __m128i s0, s1;
+
+        s0 = _mm_packs_epi32(_mm_cvttps_epi32(_mm_max_ps(_mm_min_ps(_mm_loadu_ps(&in[i   ]), upper), lower)),
+                             _mm_cvttps_epi32(_mm_max_ps(_mm_min_ps(_mm_loadu_ps(&in[i+ 4]), upper), lower)));
+        s1 = _mm_packs_epi32(_mm_cvttps_epi32(_mm_max_ps(_mm_min_ps(_mm_loadu_ps(&in[i+ 8]), upper), lower)),
+                             _mm_cvttps_epi32(_mm_max_ps(_mm_min_ps(_mm_loadu_ps(&in[i+12]), upper), lower)));
+        s0 = _mm_add_epi16(_mm_srai_epi16(s0, 8), bias);
+        s1 = _mm_add_epi16(_mm_srai_epi16(s1, 8), bias);
+        _mm_storeu_si128((__m128i*)&out[i], _mm_packus_epi16(s0, s1));
+    }
+#endif
+    for(;i < count;i++)
+        out[i] = (ALubyte)((aluF2S(in[i])>>8)+128);
+}
+
+/* Float to 32-bit float, normalized to [-1, 1). The bus already is float, so
+ * this is only a scale, and the clamp is optional; without it, peaks above
+ * full scale pass through as headroom for whatever is downstream. */
+static ALvoid aluConvertF32(const ALfloat *in, ALvoid *outptr, ALuint count)
+{
+    const ALfloat scale = 1.0f/32768.0f;
+    ALfloat *out = outptr;
+    ALuint i = 0;
+
+#ifdef HAVE_SSE2
+    const __m128 vscale = _mm_set1_ps(scale);
+
+    if(ClampFloatOutput)
+    {
+        const __m128 upper = _mm_set1_ps(1.0f);
+        const __m128 lower = _mm_set1_ps(-1.0f);
+
+        for(;i+4 <= count;i += 4)
+            _mm_storeu_ps(&out[i], _mm_max_ps(_mm_min_ps(_mm_mul_ps(_mm_loadu_ps(&in[i]), vscale), upper), lower));
     }
     else
     {
-        //1. Multi-channel buffers always play "normal"
-        pitch[0] = ALSource->flPitch;
-
-        drysend[FRONT_LEFT]  = SourceVolume * ListenerGain;
-        drysend[FRONT_RIGHT] = SourceVolume * ListenerGain;
-        drysend[SIDE_LEFT]   = SourceVolume * ListenerGain;
-        drysend[SIDE_RIGHT]  = SourceVolume * ListenerGain;
-        drysend[BACK_LEFT]   = SourceVolume * ListenerGain;
-        drysend[BACK_RIGHT]  = SourceVolume * ListenerGain;
-        drysend[CENTER]      = SourceVolume * ListenerGain;
-        drysend[LFE]         = SourceVolume * ListenerGain;
-        wetsend[FRONT_LEFT]  = 0.0f;
-        wetsend[FRONT_RIGHT] = 0.0f;
-        wetsend[SIDE_LEFT]   = 0.0f;
-        wetsend[SIDE_RIGHT]  = 0.0f;
-        wetsend[BACK_LEFT]   = 0.0f;
-        wetsend[BACK_RIGHT]  = 0.0f;
-        wetsend[CENTER]      = 0.0f;
-        wetsend[LFE]         = 0.0f;
-        WetGainHF = 1.0f;
-
-        *drygainhf = DryGainHF;
-        *wetgainhf = WetGainHF;
+        for(;i+4 <= count;i += 4)
+            _mm_storeu_ps(&out[i], _mm_mul_ps(_mm_loadu_ps(&in[i]), vscale));
+    }
+#endif
+    if(ClampFloatOutput)
+    {
+        for(;i < count;i++)
+            out[i] = __min(__max(in[i]*scale, -1.0f), 1.0f);
+    }
+    else
+    {
+        for(;i < count;i++)
+            out[i] = in[i]*scale;
+    }
+}
+
+#define MAP_MONO    { FRONT_LEFT }
+#define MAP_STEREO  { FRONT_LEFT, FRONT_RIGHT }
+#define MAP_QUAD    { FRONT_LEFT, FRONT_RIGHT, BACK_LEFT, BACK_RIGHT }
+#ifdef _WIN32 /* Of course, Windows can't use the same ordering... */
+#define MAP_51CHN   { FRONT_LEFT, FRONT_RIGHT, CENTER, LFE, BACK_LEFT, BACK_RIGHT }
+#define MAP_61CHN   { FRONT_LEFT, FRONT_RIGHT, LFE, BACK_LEFT, BACK_RIGHT, SIDE_LEFT, SIDE_RIGHT }
+#define MAP_71CHN   { FRONT_LEFT, FRONT_RIGHT, CENTER, LFE, BACK_LEFT, BACK_RIGHT, SIDE_LEFT, SIDE_RIGHT }
+#else
+#define MAP_51CHN   { FRONT_LEFT, FRONT_RIGHT, BACK_LEFT, BACK_RIGHT, CENTER, LFE }
+#define MAP_61CHN   { FRONT_LEFT, FRONT_RIGHT, BACK_LEFT, BACK_RIGHT, LFE, SIDE_LEFT, SIDE_RIGHT }
+#define MAP_71CHN   { FRONT_LEFT, FRONT_RIGHT, BACK_LEFT, BACK_RIGHT, CENTER, LFE, SIDE_LEFT, SIDE_RIGHT }
+#endif
+
+static const ALoutputlayout OutputLayouts[] = {
+    { AL_FORMAT_MONO8,    1, 1, MAP_MONO,   aluConvertU8  },
+    { AL_FORMAT_STEREO8,  2, 1, MAP_STEREO, aluConvertU8  },
+    { AL_FORMAT_QUAD8,    4, 1, MAP_QUAD,   aluConvertU8  },
+    { AL_FORMAT_51CHN8,   6, 1, MAP_51CHN,  aluConvertU8  },
+    { AL_FORMAT_61CHN8,   7, 1, MAP_61CHN,  aluConvertU8  },
+    { AL_FORMAT_71CHN8,   8, 1, MAP_71CHN,  aluConvertU8  },
+
+    { AL_FORMAT_MONO16,   1, 2, MAP_MONO,   aluConvertS16 },
+    { AL_FORMAT_STEREO16, 2, 2, MAP_STEREO, aluConvertS16 },
+    { AL_FORMAT_QUAD16,   4, 2, MAP_QUAD,   aluConvertS16 },
+    { AL_FORMAT_51CHN16,  6, 2, MAP_51CHN,  aluConvertS16 },
+    { AL_FORMAT_61CHN16,  7, 2, MAP_61CHN,  aluConvertS16 },
+    { AL_FORMAT_71CHN16,  8, 2, MAP_71CHN,  aluConvertS16 },
+
+    { AL_FORMAT_MONO_FLOAT32,   1, 4, MAP_MONO,   aluConvertF32 },
+    { AL_FORMAT_STEREO_FLOAT32, 2, 4, MAP_STEREO, aluConvertF32 },
+    { AL_FORMAT_QUAD32,         4, 4, MAP_QUAD,   aluConvertF32 },
+    { AL_FORMAT_51CHN32,        6, 4, MAP_51CHN,  aluConvertF32 },
+    { AL_FORMAT_61CHN32,        7, 4, MAP_61CHN,  aluConvertF32 },
+    { AL_FORMAT_71CHN32,        8, 4, MAP_71CHN,  aluConvertF32 },
+
+    { 0, 0, 0, { 0 }, NULL }
+};
+
+static const ALoutputlayout *aluGetOutputLayout(ALenum format)
+{
+    const ALoutputlayout *Layout = OutputLayouts;
+
+    while(Layout->Convert && Layout->Format != format)
+        Layout++;
+    return (Layout->Convert ? Layout : NULL);
+}
+
+static ALfloat Gathered[CONVERT_CHUNK*OUTPUTCHANNELS];
+
+static ALvoid aluConvertOutput(const ALoutputlayout *Layout,
+                               ALfloat (*Bus)[OUTPUTCHANNELS], ALvoid *buffer,
+                               ALuint SamplesToDo)
+{
+    const ALuint Channels = Layout->Channels;
+    const ALuint FrameSize = Channels * Layout->SampleSize;
+    ALuint base, todo, i, c;
+
+    for(base = 0;base < SamplesToDo;base += todo)
+    {
+        todo = min(SamplesToDo-base, CONVERT_CHUNK);
+
+        for(c = 0;c < Channels;c++)
+        {
+            const ALuint chan = Layout->Map[c];
+            for(i = 0;i < todo;i++)
+                Gathered[i*Channels + c] = Bus[base+i][chan];
+        }
+        Layout->Convert(Gathered, (ALubyte*)buffer + base*FrameSize,
+                        todo*Channels);
+    }
+}
+
+static float DryBuffer[BUFFERSIZE][OUTPUTCHANNELS];
+//Effect slot outputs
+static float WetBuffer[BUFFERSIZE][OUTPUTCHANNELS];
+static ALfloat VoiceBuffer[VOICE_BLOCK][OUTPUTCHANNELS];
+static ALfloat FilterBuffer[VOICE_BLOCK];
+
+/* Pins the mixer's scratch buffers in memory, so mixing never waits on a page
+ * fault. Failure (usually RLIMIT_MEMLOCK) only costs that guarantee. */
+ALvoid aluLockMixBuffers(ALvoid)
+{
+    static const struct {
+        ALvoid *ptr;
+        size_t size;
+    } Buffers[] = {
+        { DryBuffer,    sizeof(DryBuffer)    },
+        { WetBuffer,    sizeof(WetBuffer)    },
+        { VoiceBuffer,  sizeof(VoiceBuffer)  },
+        { FilterBuffer, sizeof(FilterBuffer) },
+        { Gathered,     sizeof(Gathered)     },
+    };
+    ALuint i;
+
+    for(i = 0;i < sizeof(Buffers)/sizeof(Buffers[0]);i++)
+    {
+#ifdef _WIN32
+        if(!VirtualLock(Buffers[i].ptr, Buffers[i].size))
+        {
+            AL_PRINT("Could not lock mixer buffers: %lu\n", GetLastError());
+            break;
+        }
+#else
+        if(mlock(Buffers[i].ptr, Buffers[i].size) != 0)
+        {
+            AL_PRINT("Could not lock mixer buffers: %s\n", strerror(errno));
+            break;
+        }
+#endif
     }
 }
 
 ALvoid aluMixData(ALCcontext *ALContext,ALvoid *buffer,ALsizei size,ALenum format)
 {
-    static float DryBuffer[BUFFERSIZE][OUTPUTCHANNELS];
-    static float WetBuffer[BUFFERSIZE][OUTPUTCHANNELS];
-    static float ReverbBuffer[BUFFERSIZE];
-    ALfloat DrySend[OUTPUTCHANNELS] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
-    ALfloat WetSend[OUTPUTCHANNELS] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
-    ALfloat DryGainHF = 0.0f;
-    ALfloat WetGainHF = 0.0f;
+    ALfloat *DrySend;
+    ALfloat *SendBuffer[MAX_SENDS];
+    ALfloat WetSend[MAX_SENDS];
+    ALuint SendIndex[MAX_SENDS];
+    ALuint NumSends = 0;
     ALuint BlockAlign,BufferSize;
     ALuint DataSize=0,DataPosInt=0,DataPosFrac=0;
     ALuint Channels,Frequency,ulExtraSamples;
-    ALfloat DrySample, WetSample;
-    ALboolean doReverb;
     ALfloat Pitch;
     ALint Looping,increment,State;
     ALuint Buffer,fraction;
@@ -598,15 +1457,29 @@ ALvoid aluMixData(ALCcontext *ALContext,ALvoid *buffer,ALsizei size,ALenum forma
     ALsource *ALSource;
     ALbuffer *ALBuffer;
     ALeffectslot *ALEffectSlot;
-    ALfloat value;
     ALshort *Data;
-    ALuint i,j,k;
+    ALuint i,j,k,c,f,s;
+    ALuint todo;
+    const ALoutputlayout *Layout;
     ALbufferlistitem *BufferListItem;
     ALuint loop;
+    ALuint MipLevel;
     ALint64 DataSize64,DataPos64;
+#ifdef HAVE_SSE_CSR
+    unsigned int OldCSR;
+#endif
 
     SuspendContext(ALContext);
 
+    Layout = aluGetOutputLayout(format);
+
+#ifdef HAVE_SSE_CSR
+    // Have the FPU drop denormals from the filter and reverb tails. The
+    // state is flushed explicitly as well, for FPUs this doesn't cover
+    OldCSR = _mm_getcsr();
+    _mm_setcsr(OldCSR | SSE_CSR_FLUSH);
+#endif
+
     //Figure output format variables
     BlockAlign  = aluChannelsFromFormat(format);
     BlockAlign *= aluBytesFromFormat(format);
@@ -622,7 +1495,20 @@ ALvoid aluMixData(ALCcontext *ALContext,ALvoid *buffer,ALsizei size,ALenum forma
         //Clear mixing buffer
         memset(DryBuffer, 0, SamplesToDo*OUTPUTCHANNELS*sizeof(ALfloat));
         memset(WetBuffer, 0, SamplesToDo*OUTPUTCHANNELS*sizeof(ALfloat));
-        memset(ReverbBuffer, 0, SamplesToDo*sizeof(ALfloat));
+        while(ALEffectSlot)
+        {
+            memset(ALEffectSlot->WetBuffer, 0, SamplesToDo*sizeof(ALfloat));
+            ALEffectSlot = ALEffectSlot->next;
+        }
+        ALEffectSlot = (ALContext ? ALContext->AuxiliaryEffectSlot : NULL);
+
+        if(ALContext)
+        {
+            if(ALContext->SourceGrid)
+                QuerySourceGrid(ALContext);
+            CalcAllSourceParams(ALContext, format);
+            LimitVoices(ALContext);
+        }
 
         //Actual mixing loop
         while(ALSource)
@@ -630,10 +1516,6 @@ ALvoid aluMixData(ALCcontext *ALContext,ALvoid *buffer,ALsizei size,ALenum forma
             j = 0;
             State = ALSource->state;
 
-            doReverb = ((ALSource->Send[0].Slot &&
-                            ALSource->Send[0].Slot->effect.type == AL_EFFECT_REVERB) ?
-                        AL_TRUE : AL_FALSE);
-
             while(State == AL_PLAYING && j < SamplesToDo)
             {
                 DataSize = 0;
@@ -650,10 +1532,45 @@ ALvoid aluMixData(ALCcontext *ALContext,ALvoid *buffer,ALsizei size,ALenum forma
                     DataSize  = ALBuffer->size;
                     Frequency = ALBuffer->frequency;
 
-                    CalcSourceParams(ALContext, ALSource,
-                                        (Channels==1) ? AL_TRUE : AL_FALSE,
-                                        format, DrySend, WetSend, &Pitch,
-                                        &DryGainHF, &WetGainHF);
+                    //The queue moved on to a buffer with a different channel
+                    //count, so the gains calculated at the start of this
+                    //update are for the wrong kind of source
+                    if(Channels != ALSource->Params.Channels)
+                        CalcSourceParams(ALContext, ALSource, format);
+
+                    DrySend = ALSource->Params.DrySend;
+                    if(Channels == 1 && ALSource->InGrid &&
+                       ALSource->GridStamp != ALContext->GridStamp)
+                    {
+                        //The source grid found it out of range, so skip the
+                        //3D calculations altogether
+                        Pitch = ALSource->flPitch;
+                        ALSource->IsVirtual = AL_TRUE;
+                    }
+                    else
+                    {
+                        Pitch = ALSource->Params.Pitch;
+
+                        //Sources that can't be heard, or that don't fit in
+                        //the voice limit, become virtual voices
+                        ALSource->IsVirtual = ALSource->VoiceLimited;
+                        if(ALSource->Audibility < ALContext->VoiceCullGain)
+                            ALSource->IsVirtual = AL_TRUE;
+                    }
+
+                    //Gather the sends that feed a slot. Each block is
+                    //resampled once, then filtered and added into every
+                    //slot's input.
+                    NumSends = 0;
+                    for(s = 0;Channels == 1 && s < ALContext->Device->NumAuxSends;s++)
+                    {
+                        if(!ALSource->Send[s].Slot)
+                            continue;
+                        SendIndex[NumSends]  = s;
+                        SendBuffer[NumSends] = ALSource->Send[s].Slot->WetBuffer;
+                        WetSend[NumSends]    = ALSource->Params.Send[s].WetGain;
+                        NumSends++;
+                    }
 
 
                     Pitch = (Pitch*Frequency) / ALContext->Frequency;
@@ -662,8 +1579,30 @@ ALvoid aluMixData(ALCcontext *ALContext,ALvoid *buffer,ALsizei size,ALenum forma
                     //Get source info
                     DataPosInt = ALSource->position;
                     DataPosFrac = ALSource->position_fraction;
-                    DrySample = ALSource->LastDrySample;
-                    WetSample = ALSource->LastWetSample;
+
+                    //Read from a pre-filtered, decimated copy of the buffer
+                    //when playing at high pitch, keeping the step closest to
+                    //(but not below) 1
+                    MipLevel = 0;
+                    while(MipLevel < BUFFER_MIP_LEVELS && Pitch > 2.0f)
+                    {
+                        ALshort *MipData = GetBufferMipData(ALBuffer, MipLevel+1);
+                        if(!MipData)
+                            break;
+                        Data = MipData;
+                        Pitch *= 0.5f;
+                        MipLevel++;
+                    }
+                    DataPos64 = DataPosInt;
+                    DataPos64 <<= FRACTIONBITS;
+                    DataPos64 += DataPosFrac;
+                    if(MipLevel > 0)
+                    {
+                        DataSize = GetBufferMipFrames(ALBuffer, MipLevel);
+                        DataPos64 >>= MipLevel;
+                        DataPosInt = (ALuint)(DataPos64>>FRACTIONBITS);
+                        DataPosFrac = (ALuint)(DataPos64&FRACTIONMASK);
+                    }
 
                     //Compute 18.14 fixed point step
                     increment = (ALint)(Pitch*(ALfloat)(1L<<FRACTIONBITS));
@@ -674,9 +1613,6 @@ ALvoid aluMixData(ALCcontext *ALContext,ALvoid *buffer,ALsizei size,ALenum forma
                     //Pitch must be <= 4 (the number below !)
                     DataSize64 = DataSize+MAX_PITCH;
                     DataSize64 <<= FRACTIONBITS;
-                    DataPos64 = DataPosInt;
-                    DataPos64 <<= FRACTIONBITS;
-                    DataPos64 += DataPosFrac;
                     BufferSize = (ALuint)((DataSize64-DataPos64) / increment);
                     BufferListItem = ALSource->queue;
                     for(loop = 0; loop < ALSource->BuffersPlayed; loop++)
@@ -686,134 +1622,148 @@ ALvoid aluMixData(ALCcontext *ALContext,ALvoid *buffer,ALsizei size,ALenum forma
                     }
                     if (BufferListItem)
                     {
+                        ALbuffer *NextBuf = NULL;
                         if (BufferListItem->next)
-                        {
-                            ALbuffer *NextBuf = (ALbuffer*)ALTHUNK_LOOKUPENTRY(BufferListItem->next->buffer);
-                            if(NextBuf && NextBuf->data)
-                            {
-                                ulExtraSamples = min(NextBuf->size, (ALint)(16*Channels));
-                                memcpy(&Data[DataSize*Channels], NextBuf->data, ulExtraSamples);
-                            }
-                        }
+                            NextBuf = (ALbuffer*)ALTHUNK_LOOKUPENTRY(BufferListItem->next->buffer);
                         else if (ALSource->bLooping)
+                            NextBuf = (ALbuffer*)ALTHUNK_LOOKUPENTRY(ALSource->queue->buffer);
+                        if (NextBuf && NextBuf->data)
                         {
-                            ALbuffer *NextBuf = (ALbuffer*)ALTHUNK_LOOKUPENTRY(ALSource->queue->buffer);
-                            if (NextBuf && NextBuf->data)
+                            ALshort *NextData = GetBufferMipData(NextBuf, MipLevel);
+                            if (NextData)
                             {
-                                ulExtraSamples = min(NextBuf->size, (ALint)(16*Channels));
-                                memcpy(&Data[DataSize*Channels], NextBuf->data, ulExtraSamples);
+                                ulExtraSamples = GetBufferMipFrames(NextBuf, MipLevel) *
+                                                 aluChannelsFromFormat(NextBuf->format) *
+                                                 sizeof(ALshort);
+                                ulExtraSamples = min(ulExtraSamples, 16*Channels);
+                                memcpy(&Data[DataSize*Channels], NextData, ulExtraSamples);
                             }
                         }
                     }
                     BufferSize = min(BufferSize, (SamplesToDo-j));
 
+                    //Virtual voices only advance their position
+                    if(ALSource->IsVirtual)
+                    {
+                        DataPosFrac += increment*BufferSize;
+                        j += BufferSize;
+                        BufferSize = 0;
+                    }
+
                     //Actual sample mixing loop
                     Data += DataPosInt*Channels;
-                    while(BufferSize--)
+                    while(BufferSize > 0)
                     {
-                        k = DataPosFrac>>FRACTIONBITS;
-                        fraction = DataPosFrac&FRACTIONMASK;
+                        todo = min(BufferSize, VOICE_BLOCK);
+
+                        //First order interpolator, for every channel
+                        for(i = 0;i < todo;i++)
+                        {
+                            ALshort *frame1, *frame2;
+
+                            k = DataPosFrac>>FRACTIONBITS;
+                            fraction = DataPosFrac&FRACTIONMASK;
+                            frame1 = &Data[k*Channels];
+                            frame2 = frame1 + Channels;
+                            for(c = 0;c < Channels;c++)
+                                VoiceBuffer[i][c] = (ALfloat)((ALshort)(((frame1[c]*((1L<<FRACTIONBITS)-fraction))+(frame2[c]*(fraction)))>>FRACTIONBITS));
+                            DataPosFrac += increment;
+                        }
+
                         if(Channels==1)
                         {
-                            //First order interpolator
-                            ALfloat sample = (ALfloat)((ALshort)(((Data[k]*((1L<<FRACTIONBITS)-fraction))+(Data[k+1]*(fraction)))>>FRACTIONBITS));
-
-                            //Direct path final mix buffer and panning
-                            DrySample = aluComputeSample(DryGainHF, sample, DrySample);
-                            DryBuffer[j][FRONT_LEFT]  += DrySample*DrySend[FRONT_LEFT];
-                            DryBuffer[j][FRONT_RIGHT] += DrySample*DrySend[FRONT_RIGHT];
-                            DryBuffer[j][SIDE_LEFT]   += DrySample*DrySend[SIDE_LEFT];
-                            DryBuffer[j][SIDE_RIGHT]  += DrySample*DrySend[SIDE_RIGHT];
-                            DryBuffer[j][BACK_LEFT]   += DrySample*DrySend[BACK_LEFT];
-                            DryBuffer[j][BACK_RIGHT]  += DrySample*DrySend[BACK_RIGHT];
-                            //Room path final mix buffer and panning
-                            WetSample = aluComputeSample(WetGainHF, sample, WetSample);
-                            if(doReverb)
-                                ReverbBuffer[j] += WetSample;
-                            else
+                            //Direct path filters, final mix buffer and panning
+                            for(i = 0;i < todo;i++)
+                                FilterBuffer[i] = VoiceBuffer[i][0];
+                            for(f = 0;f < 2;f++)
                             {
-                                WetBuffer[j][FRONT_LEFT]  += WetSample*WetSend[FRONT_LEFT];
-                                WetBuffer[j][FRONT_RIGHT] += WetSample*WetSend[FRONT_RIGHT];
-                                WetBuffer[j][SIDE_LEFT]   += WetSample*WetSend[SIDE_LEFT];
-                                WetBuffer[j][SIDE_RIGHT]  += WetSample*WetSend[SIDE_RIGHT];
-                                WetBuffer[j][BACK_LEFT]   += WetSample*WetSend[BACK_LEFT];
-                                WetBuffer[j][BACK_RIGHT]  += WetSample*WetSend[BACK_RIGHT];
+                                if(ALSource->Params.DryFilterOn[f])
+                                    aluFilterBlock(&ALSource->Params.DryFilter[f],
+                                                   ALSource->DryFilterState[f][0],
+                                                   ALSource->DryFilterState[f][1],
+                                                   FilterBuffer, 1, 1, todo);
+                            }
+                            for(i = 0;i < todo;i++)
+                            {
+                                ALfloat sample = FilterBuffer[i];
+                                DryBuffer[j+i][FRONT_LEFT]  += sample*DrySend[FRONT_LEFT];
+                                DryBuffer[j+i][FRONT_RIGHT] += sample*DrySend[FRONT_RIGHT];
+                                DryBuffer[j+i][SIDE_LEFT]   += sample*DrySend[SIDE_LEFT];
+                                DryBuffer[j+i][SIDE_RIGHT]  += sample*DrySend[SIDE_RIGHT];
+                                DryBuffer[j+i][BACK_LEFT]   += sample*DrySend[BACK_LEFT];
+                                DryBuffer[j+i][BACK_RIGHT]  += sample*DrySend[BACK_RIGHT];
+                            }
+
+                            //Room path, into each send's effect slot
+                            for(s = 0;s < NumSends;s++)
+                            {
+                                ALuint send = SendIndex[s];
+
+                                for(i = 0;i < todo;i++)
+                                    FilterBuffer[i] = VoiceBuffer[i][0];
+                                for(f = 0;f < 2;f++)
+                                {
+                                    if(ALSource->Params.Send[send].WetFilterOn[f])
+                                        aluFilterBlock(&ALSource->Params.Send[send].WetFilter[f],
+                                                       &ALSource->WetFilterState[send][f][0],
+                                                       &ALSource->WetFilterState[send][f][1],
+                                                       FilterBuffer, 1, 1, todo);
+                                }
+                                for(i = 0;i < todo;i++)
+                                    SendBuffer[s][j+i] += FilterBuffer[i]*WetSend[s];
                             }
                         }
                         else
                         {
-                            ALfloat samp1, samp2;
-                            //First order interpolator (front left)
-                            samp1 = (ALfloat)((ALshort)(((Data[k*Channels  ]*((1L<<FRACTIONBITS)-fraction))+(Data[(k+1)*Channels  ]*(fraction)))>>FRACTIONBITS));
-                            DryBuffer[j][FRONT_LEFT] += samp1*DrySend[FRONT_LEFT];
-                            WetBuffer[j][FRONT_LEFT] += samp1*WetSend[FRONT_LEFT];
-                            //First order interpolator (front right)
-                            samp2 = (ALfloat)((ALshort)(((Data[k*Channels+1]*((1L<<FRACTIONBITS)-fraction))+(Data[(k+1)*Channels+1]*(fraction)))>>FRACTIONBITS));
-                            DryBuffer[j][FRONT_RIGHT] += samp2*DrySend[FRONT_RIGHT];
-                            WetBuffer[j][FRONT_RIGHT] += samp2*WetSend[FRONT_RIGHT];
-                            if(Channels >= 4)
+                            const ALuint *Map = ChannelMap[Channels];
+
+                            for(f = 0;f < 2;f++)
                             {
-                                int i = 2;
-                                if(Channels >= 6)
-                                {
-                                    if(Channels != 7)
-                                    {
-                                        //First order interpolator (center)
-                                        value = (ALfloat)((ALshort)(((Data[k*Channels+i]*((1L<<FRACTIONBITS)-fraction))+(Data[(k+1)*Channels+i]*(fraction)))>>FRACTIONBITS));
-                                        DryBuffer[j][CENTER] += value*DrySend[CENTER];
-                                        WetBuffer[j][CENTER] += value*WetSend[CENTER];
-                                        i++;
-                                    }
-                                    //First order interpolator (lfe)
-                                    value = (ALfloat)((ALshort)(((Data[k*Channels+i]*((1L<<FRACTIONBITS)-fraction))+(Data[(k+1)*Channels+i]*(fraction)))>>FRACTIONBITS));
-                                    DryBuffer[j][LFE] += value*DrySend[LFE];
-                                    WetBuffer[j][LFE] += value*WetSend[LFE];
-                                    i++;
-                                }
-                                //First order interpolator (back left)
-                                value = (ALfloat)((ALshort)(((Data[k*Channels+i]*((1L<<FRACTIONBITS)-fraction))+(Data[(k+1)*Channels+i]*(fraction)))>>FRACTIONBITS));
-                                DryBuffer[j][BACK_LEFT] += value*DrySend[BACK_LEFT];
-                                WetBuffer[j][BACK_LEFT] += value*WetSend[BACK_LEFT];
-                                i++;
-                                //First order interpolator (back right)
-                                value = (ALfloat)((ALshort)(((Data[k*Channels+i]*((1L<<FRACTIONBITS)-fraction))+(Data[(k+1)*Channels+i]*(fraction)))>>FRACTIONBITS));
-                                DryBuffer[j][BACK_RIGHT] += value*DrySend[BACK_RIGHT];
-                                WetBuffer[j][BACK_RIGHT] += value*WetSend[BACK_RIGHT];
-                                i++;
-                                if(Channels >= 7)
-                                {
-                                    //First order interpolator (side left)
-                                    value = (ALfloat)((ALshort)(((Data[k*Channels+i]*((1L<<FRACTIONBITS)-fraction))+(Data[(k+1)*Channels+i]*(fraction)))>>FRACTIONBITS));
-                                    DryBuffer[j][SIDE_LEFT] += value*DrySend[SIDE_LEFT];
-                                    WetBuffer[j][SIDE_LEFT] += value*WetSend[SIDE_LEFT];
-                                    i++;
-                                    //First order interpolator (side right)
-                                    value = (ALfloat)((ALshort)(((Data[k*Channels+i]*((1L<<FRACTIONBITS)-fraction))+(Data[(k+1)*Channels+i]*(fraction)))>>FRACTIONBITS));
-                                    DryBuffer[j][SIDE_RIGHT] += value*DrySend[SIDE_RIGHT];
-                                    WetBuffer[j][SIDE_RIGHT] += value*WetSend[SIDE_RIGHT];
-                                    i++;
-                                }
+                                if(ALSource->Params.DryFilterOn[f])
+                                    aluFilterBlock(&ALSource->Params.DryFilter[f],
+                                                   ALSource->DryFilterState[f][0],
+                                                   ALSource->DryFilterState[f][1],
+                                                   VoiceBuffer[0], OUTPUTCHANNELS,
+                                                   Channels, todo);
+                            }
+                            for(i = 0;i < todo;i++)
+                            {
+                                for(c = 0;c < Channels;c++)
+                                    DryBuffer[j+i][Map[c]] += VoiceBuffer[i][c]*DrySend[Map[c]];
                             }
-                            else if(DuplicateStereo)
+                            if(Channels == 2 && DuplicateStereo)
                             {
                                 //Duplicate stereo channels on the back speakers
-                                DryBuffer[j][BACK_LEFT] += samp1*DrySend[BACK_LEFT];
-                                WetBuffer[j][BACK_LEFT] += samp1*WetSend[BACK_LEFT];
-                                DryBuffer[j][BACK_RIGHT] += samp2*DrySend[BACK_RIGHT];
-                                WetBuffer[j][BACK_RIGHT] += samp2*WetSend[BACK_RIGHT];
+                                for(i = 0;i < todo;i++)
+                                {
+                                    DryBuffer[j+i][BACK_LEFT]  += VoiceBuffer[i][0]*DrySend[BACK_LEFT];
+                                    DryBuffer[j+i][BACK_RIGHT] += VoiceBuffer[i][1]*DrySend[BACK_RIGHT];
+                                }
                             }
                         }
-                        DataPosFrac += increment;
-                        j++;
+
+                        BufferSize -= todo;
+                        j += todo;
                     }
                     DataPosInt += (DataPosFrac>>FRACTIONBITS);
                     DataPosFrac = (DataPosFrac&FRACTIONMASK);
 
+                    //Convert the position back to the buffer's own rate
+                    if(MipLevel > 0)
+                    {
+                        DataPos64 = DataPosInt;
+                        DataPos64 <<= FRACTIONBITS;
+                        DataPos64 += DataPosFrac;
+                        DataPos64 <<= MipLevel;
+                        DataPosInt = (ALuint)(DataPos64>>FRACTIONBITS);
+                        DataPosFrac = (ALuint)(DataPos64&FRACTIONMASK);
+                        DataSize = ALBuffer->size;
+                        DataSize /= Channels * aluBytesFromFormat(ALBuffer->format);
+                    }
+
                     //Update source info
                     ALSource->position = DataPosInt;
                     ALSource->position_fraction = DataPosFrac;
-                    ALSource->LastDrySample = DrySample;
-                    ALSource->LastWetSample = WetSample;
                 }
 
                 //Handle looping sources
@@ -891,275 +1841,52 @@ ALvoid aluMixData(ALCcontext *ALContext,ALvoid *buffer,ALsizei size,ALenum forma
             ALSource = ALSource->next;
         }
 
-        // effect slot processing
+        // effect slot processing. Each slot only reads its own state and
+        // input bus, so they can be run in any order
         while(ALEffectSlot)
         {
-            if(ALEffectSlot->effect.type == AL_EFFECT_REVERB)
-            {
-                ALfloat *DelayBuffer = ALEffectSlot->ReverbBuffer;
-                ALuint Pos = ALEffectSlot->ReverbPos;
-                ALuint LatePos = ALEffectSlot->ReverbLatePos;
-                ALuint ReflectPos = ALEffectSlot->ReverbReflectPos;
-                ALuint Length = ALEffectSlot->ReverbLength;
-                ALfloat DecayGain = ALEffectSlot->ReverbDecayGain;
-                ALfloat DecayHFRatio = ALEffectSlot->effect.Reverb.DecayHFRatio;
-                ALfloat Gain = ALEffectSlot->effect.Reverb.Gain;
-                ALfloat ReflectGain = ALEffectSlot->effect.Reverb.ReflectionsGain;
-                ALfloat LateReverbGain = ALEffectSlot->effect.Reverb.LateReverbGain;
-                ALfloat LastDecaySample = ALEffectSlot->LastDecaySample;
-                ALfloat sample;
-
-                for(i = 0;i < SamplesToDo;i++)
-                {
-                    DelayBuffer[Pos] = ReverbBuffer[i] * Gain;
-
-                    sample = DelayBuffer[ReflectPos] * ReflectGain;
-
-                    DelayBuffer[LatePos] *= LateReverbGain;
-
-                    Pos = (Pos+1) % Length;
-                    DelayBuffer[Pos] *= DecayHFRatio;
-                    DelayBuffer[Pos] += LastDecaySample * (1.0f-DecayHFRatio);
-                    LastDecaySample = DelayBuffer[Pos];
-                    DelayBuffer[Pos] *= DecayGain;
-
-                    DelayBuffer[LatePos] += DelayBuffer[Pos];
-
-                    sample += DelayBuffer[LatePos];
-
-                    WetBuffer[i][FRONT_LEFT]  += sample;
-                    WetBuffer[i][FRONT_RIGHT] += sample;
-                    WetBuffer[i][SIDE_LEFT]   += sample;
-                    WetBuffer[i][SIDE_RIGHT]  += sample;
-                    WetBuffer[i][BACK_LEFT]   += sample;
-                    WetBuffer[i][BACK_RIGHT]  += sample;
-
-                    LatePos = (LatePos+1) % Length;
-                    ReflectPos = (ReflectPos+1) % Length;
-                }
-
-                ALEffectSlot->ReverbPos = Pos;
-                ALEffectSlot->ReverbLatePos = LatePos;
-                ALEffectSlot->ReverbReflectPos = ReflectPos;
-                ALEffectSlot->LastDecaySample = LastDecaySample;
-            }
+            if(ALEffectSlot->EffectState)
+                ALEffect_Process(ALEffectSlot->EffectState, SamplesToDo,
+                                 ALEffectSlot->WetBuffer, WetBuffer);
 
             ALEffectSlot = ALEffectSlot->next;
         }
 
-        //Post processing loop
-        switch(format)
+        //Fold the effect outputs into the mix bus, so it's converted in
+        //one pass
+        for(i = 0;i < SamplesToDo;i++)
         {
-            case AL_FORMAT_MONO8:
-                for(i = 0;i < SamplesToDo;i++)
-                {
-                    ((ALubyte*)buffer)[0] = (ALubyte)((aluF2S(DryBuffer[i][FRONT_LEFT]+DryBuffer[i][FRONT_RIGHT]+
-                                                                WetBuffer[i][FRONT_LEFT]+WetBuffer[i][FRONT_RIGHT])>>8)+128);
-                    buffer = ((ALubyte*)buffer) + 1;
-                }
-                break;
-            case AL_FORMAT_STEREO8:
-                if(ALContext && ALContext->bs2b)
-                {
-                    for(i = 0;i < SamplesToDo;i++)
-                    {
-                        float samples[2];
-                        samples[0] = DryBuffer[i][FRONT_LEFT] +WetBuffer[i][FRONT_LEFT];
-                        samples[1] = DryBuffer[i][FRONT_RIGHT]+WetBuffer[i][FRONT_RIGHT];
-                        bs2b_cross_feed(ALContext->bs2b, samples);
-                        ((ALubyte*)buffer)[0] = (ALubyte)((aluF2S(samples[0])>>8)+128);
-                        ((ALubyte*)buffer)[1] = (ALubyte)((aluF2S(samples[1])>>8)+128);
-                        buffer = ((ALubyte*)buffer) + 2;
-                    }
-                }
-                else
-                {
-                    for(i = 0;i < SamplesToDo;i++)
-                    {
-                        ((ALubyte*)buffer)[0] = (ALubyte)((aluF2S(DryBuffer[i][FRONT_LEFT] +WetBuffer[i][FRONT_LEFT])>>8)+128);
-                        ((ALubyte*)buffer)[1] = (ALubyte)((aluF2S(DryBuffer[i][FRONT_RIGHT]+WetBuffer[i][FRONT_RIGHT])>>8)+128);
-                        buffer = ((ALubyte*)buffer) + 2;
-                    }
-                }
-                break;
-            case AL_FORMAT_QUAD8:
-                for(i = 0;i < SamplesToDo;i++)
-                {
-                    ((ALubyte*)buffer)[0] = (ALubyte)((aluF2S(DryBuffer[i][FRONT_LEFT] +WetBuffer[i][FRONT_LEFT])>>8)+128);
-                    ((ALubyte*)buffer)[1] = (ALubyte)((aluF2S(DryBuffer[i][FRONT_RIGHT]+WetBuffer[i][FRONT_RIGHT])>>8)+128);
-                    ((ALubyte*)buffer)[2] = (ALubyte)((aluF2S(DryBuffer[i][BACK_LEFT]  +WetBuffer[i][BACK_LEFT])>>8)+128);
-                    ((ALubyte*)buffer)[3] = (ALubyte)((aluF2S(DryBuffer[i][BACK_RIGHT] +WetBuffer[i][BACK_RIGHT])>>8)+128);
-                    buffer = ((ALubyte*)buffer) + 4;
-                }
-                break;
-            case AL_FORMAT_51CHN8:
-                for(i = 0;i < SamplesToDo;i++)
-                {
-                    ((ALubyte*)buffer)[0] = (ALubyte)((aluF2S(DryBuffer[i][FRONT_LEFT] +WetBuffer[i][FRONT_LEFT])>>8)+128);
-                    ((ALubyte*)buffer)[1] = (ALubyte)((aluF2S(DryBuffer[i][FRONT_RIGHT]+WetBuffer[i][FRONT_RIGHT])>>8)+128);
-#ifdef _WIN32 /* Of course, Windows can't use the same ordering... */
-                    ((ALubyte*)buffer)[2] = (ALubyte)((aluF2S(DryBuffer[i][CENTER]     +WetBuffer[i][CENTER])>>8)+128);
-                    ((ALubyte*)buffer)[3] = (ALubyte)((aluF2S(DryBuffer[i][LFE]        +WetBuffer[i][LFE])>>8)+128);
-                    ((ALubyte*)buffer)[4] = (ALubyte)((aluF2S(DryBuffer[i][BACK_LEFT]  +WetBuffer[i][BACK_LEFT])>>8)+128);
-                    ((ALubyte*)buffer)[5] = (ALubyte)((aluF2S(DryBuffer[i][BACK_RIGHT] +WetBuffer[i][BACK_RIGHT])>>8)+128);
-#else
-                    ((ALubyte*)buffer)[2] = (ALubyte)((aluF2S(DryBuffer[i][BACK_LEFT]  +WetBuffer[i][BACK_LEFT])>>8)+128);
-                    ((ALubyte*)buffer)[3] = (ALubyte)((aluF2S(DryBuffer[i][BACK_RIGHT] +WetBuffer[i][BACK_RIGHT])>>8)+128);
-                    ((ALubyte*)buffer)[4] = (ALubyte)((aluF2S(DryBuffer[i][CENTER]     +WetBuffer[i][CENTER])>>8)+128);
-                    ((ALubyte*)buffer)[5] = (ALubyte)((aluF2S(DryBuffer[i][LFE]        +WetBuffer[i][LFE])>>8)+128);
-#endif
-                    buffer = ((ALubyte*)buffer) + 6;
-                }
-                break;
-            case AL_FORMAT_61CHN8:
-                for(i = 0;i < SamplesToDo;i++)
-                {
-                    ((ALubyte*)buffer)[0] = (ALubyte)((aluF2S(DryBuffer[i][FRONT_LEFT] +WetBuffer[i][FRONT_LEFT])>>8)+128);
-                    ((ALubyte*)buffer)[1] = (ALubyte)((aluF2S(DryBuffer[i][FRONT_RIGHT]+WetBuffer[i][FRONT_RIGHT])>>8)+128);
-#ifdef _WIN32
-                    ((ALubyte*)buffer)[2] = (ALubyte)((aluF2S(DryBuffer[i][LFE]        +WetBuffer[i][LFE])>>8)+128);
-                    ((ALubyte*)buffer)[3] = (ALubyte)((aluF2S(DryBuffer[i][BACK_LEFT]  +WetBuffer[i][BACK_LEFT])>>8)+128);
-                    ((ALubyte*)buffer)[4] = (ALubyte)((aluF2S(DryBuffer[i][BACK_RIGHT] +WetBuffer[i][BACK_RIGHT])>>8)+128);
-#else
-                    ((ALubyte*)buffer)[2] = (ALubyte)((aluF2S(DryBuffer[i][BACK_LEFT]  +WetBuffer[i][BACK_LEFT])>>8)+128);
-                    ((ALubyte*)buffer)[3] = (ALubyte)((aluF2S(DryBuffer[i][BACK_RIGHT] +WetBuffer[i][BACK_RIGHT])>>8)+128);
-                    ((ALubyte*)buffer)[4] = (ALubyte)((aluF2S(DryBuffer[i][LFE]        +WetBuffer[i][LFE])>>8)+128);
-#endif
-                    ((ALubyte*)buffer)[5] = (ALubyte)((aluF2S(DryBuffer[i][SIDE_LEFT]  +WetBuffer[i][SIDE_LEFT])>>8)+128);
-                    ((ALubyte*)buffer)[6] = (ALubyte)((aluF2S(DryBuffer[i][SIDE_RIGHT] +WetBuffer[i][SIDE_RIGHT])>>8)+128);
-                    buffer = ((ALubyte*)buffer) + 7;
-                }
-                break;
-            case AL_FORMAT_71CHN8:
-                for(i = 0;i < SamplesToDo;i++)
-                {
-                    ((ALubyte*)buffer)[0] = (ALubyte)((aluF2S(DryBuffer[i][FRONT_LEFT] +WetBuffer[i][FRONT_LEFT])>>8)+128);
-                    ((ALubyte*)buffer)[1] = (ALubyte)((aluF2S(DryBuffer[i][FRONT_RIGHT]+WetBuffer[i][FRONT_RIGHT])>>8)+128);
-#ifdef _WIN32
-                    ((ALubyte*)buffer)[2] = (ALubyte)((aluF2S(DryBuffer[i][CENTER]     +WetBuffer[i][CENTER])>>8)+128);
-                    ((ALubyte*)buffer)[3] = (ALubyte)((aluF2S(DryBuffer[i][LFE]        +WetBuffer[i][LFE])>>8)+128);
-                    ((ALubyte*)buffer)[4] = (ALubyte)((aluF2S(DryBuffer[i][BACK_LEFT]  +WetBuffer[i][BACK_LEFT])>>8)+128);
-                    ((ALubyte*)buffer)[5] = (ALubyte)((aluF2S(DryBuffer[i][BACK_RIGHT] +WetBuffer[i][BACK_RIGHT])>>8)+128);
-#else
-                    ((ALubyte*)buffer)[2] = (ALubyte)((aluF2S(DryBuffer[i][BACK_LEFT]  +WetBuffer[i][BACK_LEFT])>>8)+128);
-                    ((ALubyte*)buffer)[3] = (ALubyte)((aluF2S(DryBuffer[i][BACK_RIGHT] +WetBuffer[i][BACK_RIGHT])>>8)+128);
-                    ((ALubyte*)buffer)[4] = (ALubyte)((aluF2S(DryBuffer[i][CENTER]     +WetBuffer[i][CENTER])>>8)+128);
-                    ((ALubyte*)buffer)[5] = (ALubyte)((aluF2S(DryBuffer[i][LFE]        +WetBuffer[i][LFE])>>8)+128);
-#endif
-                    ((ALubyte*)buffer)[6] = (ALubyte)((aluF2S(DryBuffer[i][SIDE_LEFT]  +WetBuffer[i][SIDE_LEFT])>>8)+128);
-                    ((ALubyte*)buffer)[7] = (ALubyte)((aluF2S(DryBuffer[i][SIDE_RIGHT] +WetBuffer[i][SIDE_RIGHT])>>8)+128);
-                    buffer = ((ALubyte*)buffer) + 8;
-                }
-                break;
+            for(c = 0;c < OUTPUTCHANNELS;c++)
+                DryBuffer[i][c] += WetBuffer[i][c];
+        }
 
-            case AL_FORMAT_MONO16:
-                for(i = 0;i < SamplesToDo;i++)
-                {
-                    ((ALshort*)buffer)[0] = aluF2S(DryBuffer[i][FRONT_LEFT]+DryBuffer[i][FRONT_RIGHT]+
-                                                    WetBuffer[i][FRONT_LEFT]+WetBuffer[i][FRONT_RIGHT]);
-                    buffer = ((ALshort*)buffer) + 1;
-                }
-                break;
-            case AL_FORMAT_STEREO16:
-                if(ALContext && ALContext->bs2b)
-                {
-                    for(i = 0;i < SamplesToDo;i++)
-                    {
-                        float samples[2];
-                        samples[0] = DryBuffer[i][FRONT_LEFT] +WetBuffer[i][FRONT_LEFT];
-                        samples[1] = DryBuffer[i][FRONT_RIGHT]+WetBuffer[i][FRONT_RIGHT];
-                        bs2b_cross_feed(ALContext->bs2b, samples);
-                        ((ALshort*)buffer)[0] = aluF2S(samples[0]);
-                        ((ALshort*)buffer)[1] = aluF2S(samples[1]);
-                        buffer = ((ALshort*)buffer) + 2;
-                    }
-                }
-                else
-                {
-                    for(i = 0;i < SamplesToDo;i++)
-                    {
-                        ((ALshort*)buffer)[0] = aluF2S(DryBuffer[i][FRONT_LEFT] +WetBuffer[i][FRONT_LEFT]);
-                        ((ALshort*)buffer)[1] = aluF2S(DryBuffer[i][FRONT_RIGHT]+WetBuffer[i][FRONT_RIGHT]);
-                        buffer = ((ALshort*)buffer) + 2;
-                    }
-                }
-                break;
-            case AL_FORMAT_QUAD16:
-                for(i = 0;i < SamplesToDo;i++)
-                {
-                    ((ALshort*)buffer)[0] = aluF2S(DryBuffer[i][FRONT_LEFT] +WetBuffer[i][FRONT_LEFT]);
-                    ((ALshort*)buffer)[1] = aluF2S(DryBuffer[i][FRONT_RIGHT]+WetBuffer[i][FRONT_RIGHT]);
-                    ((ALshort*)buffer)[2] = aluF2S(DryBuffer[i][BACK_LEFT]  +WetBuffer[i][BACK_LEFT]);
-                    ((ALshort*)buffer)[3] = aluF2S(DryBuffer[i][BACK_RIGHT] +WetBuffer[i][BACK_RIGHT]);
-                    buffer = ((ALshort*)buffer) + 4;
-                }
-                break;
-            case AL_FORMAT_51CHN16:
-                for(i = 0;i < SamplesToDo;i++)
-                {
-                    ((ALshort*)buffer)[0] = aluF2S(DryBuffer[i][FRONT_LEFT] +WetBuffer[i][FRONT_LEFT]);
-                    ((ALshort*)buffer)[1] = aluF2S(DryBuffer[i][FRONT_RIGHT]+WetBuffer[i][FRONT_RIGHT]);
-#ifdef _WIN32
-                    ((ALshort*)buffer)[2] = aluF2S(DryBuffer[i][CENTER]     +WetBuffer[i][CENTER]);
-                    ((ALshort*)buffer)[3] = aluF2S(DryBuffer[i][LFE]        +WetBuffer[i][LFE]);
-                    ((ALshort*)buffer)[4] = aluF2S(DryBuffer[i][BACK_LEFT]  +WetBuffer[i][BACK_LEFT]);
-                    ((ALshort*)buffer)[5] = aluF2S(DryBuffer[i][BACK_RIGHT] +WetBuffer[i][BACK_RIGHT]);
-#else
-                    ((ALshort*)buffer)[2] = aluF2S(DryBuffer[i][BACK_LEFT]  +WetBuffer[i][BACK_LEFT]);
-                    ((ALshort*)buffer)[3] = aluF2S(DryBuffer[i][BACK_RIGHT] +WetBuffer[i][BACK_RIGHT]);
-                    ((ALshort*)buffer)[4] = aluF2S(DryBuffer[i][CENTER]     +WetBuffer[i][CENTER]);
-                    ((ALshort*)buffer)[5] = aluF2S(DryBuffer[i][LFE]        +WetBuffer[i][LFE]);
-#endif
-                    buffer = ((ALshort*)buffer) + 6;
-                }
-                break;
-            case AL_FORMAT_61CHN16:
-                for(i = 0;i < SamplesToDo;i++)
-                {
-                    ((ALshort*)buffer)[0] = aluF2S(DryBuffer[i][FRONT_LEFT] +WetBuffer[i][FRONT_LEFT]);
-                    ((ALshort*)buffer)[1] = aluF2S(DryBuffer[i][FRONT_RIGHT]+WetBuffer[i][FRONT_RIGHT]);
-#ifdef _WIN32
-                    ((ALshort*)buffer)[2] = aluF2S(DryBuffer[i][LFE]        +WetBuffer[i][LFE]);
-                    ((ALshort*)buffer)[3] = aluF2S(DryBuffer[i][BACK_LEFT]  +WetBuffer[i][BACK_LEFT]);
-                    ((ALshort*)buffer)[4] = aluF2S(DryBuffer[i][BACK_RIGHT] +WetBuffer[i][BACK_RIGHT]);
-#else
-                    ((ALshort*)buffer)[2] = aluF2S(DryBuffer[i][BACK_LEFT]  +WetBuffer[i][BACK_LEFT]);
-                    ((ALshort*)buffer)[3] = aluF2S(DryBuffer[i][BACK_RIGHT] +WetBuffer[i][BACK_RIGHT]);
-                    ((ALshort*)buffer)[4] = aluF2S(DryBuffer[i][LFE]        +WetBuffer[i][LFE]);
-#endif
-                    ((ALshort*)buffer)[5] = aluF2S(DryBuffer[i][SIDE_LEFT]  +WetBuffer[i][SIDE_LEFT]);
-                    ((ALshort*)buffer)[6] = aluF2S(DryBuffer[i][SIDE_RIGHT] +WetBuffer[i][SIDE_RIGHT]);
-                    buffer = ((ALshort*)buffer) + 7;
-                }
-                break;
-            case AL_FORMAT_71CHN16:
-                for(i = 0;i < SamplesToDo;i++)
-                {
-                    ((ALshort*)buffer)[0] = aluF2S(DryBuffer[i][FRONT_LEFT] +WetBuffer[i][FRONT_LEFT]);
-                    ((ALshort*)buffer)[1] = aluF2S(DryBuffer[i][FRONT_RIGHT]+WetBuffer[i][FRONT_RIGHT]);
-#ifdef _WIN32
-                    ((ALshort*)buffer)[2] = aluF2S(DryBuffer[i][CENTER]     +WetBuffer[i][CENTER]);
-                    ((ALshort*)buffer)[3] = aluF2S(DryBuffer[i][LFE]        +WetBuffer[i][LFE]);
-                    ((ALshort*)buffer)[4] = aluF2S(DryBuffer[i][BACK_LEFT]  +WetBuffer[i][BACK_LEFT]);
-                    ((ALshort*)buffer)[5] = aluF2S(DryBuffer[i][BACK_RIGHT] +WetBuffer[i][BACK_RIGHT]);
-#else
-                    ((ALshort*)buffer)[2] = aluF2S(DryBuffer[i][BACK_LEFT]  +WetBuffer[i][BACK_LEFT]);
-                    ((ALshort*)buffer)[3] = aluF2S(DryBuffer[i][BACK_RIGHT] +WetBuffer[i][BACK_RIGHT]);
-                    ((ALshort*)buffer)[4] = aluF2S(DryBuffer[i][CENTER]     +WetBuffer[i][CENTER]);
-                    ((ALshort*)buffer)[5] = aluF2S(DryBuffer[i][LFE]        +WetBuffer[i][LFE]);
-#endif
-                    ((ALshort*)buffer)[6] = aluF2S(DryBuffer[i][SIDE_LEFT]  +WetBuffer[i][SIDE_LEFT]);
-                    ((ALshort*)buffer)[7] = aluF2S(DryBuffer[i][SIDE_RIGHT] +WetBuffer[i][SIDE_RIGHT]);
-                    buffer = ((ALshort*)buffer) + 8;
-                }
-                break;
+        //Headphone crossfeed runs on the front pair of the mix bus, before
+        //it's converted, so it works the same for any stereo format
+        if(ALContext && ALContext->bs2b && aluChannelsFromFormat(format) == 2)
+            bs2b_cross_feed_block(ALContext->bs2b, &DryBuffer[0][FRONT_LEFT],
+                                  &DryBuffer[0][FRONT_RIGHT], OUTPUTCHANNELS,
+                                  SamplesToDo);
 
-            default:
-                break;
+        //Convert straight into the device's buffer
+        if(Layout)
+        {
+            if(Layout->Channels == 1)
+            {
+                //Mono output gets the front pair
+                for(i = 0;i < SamplesToDo;i++)
+                    DryBuffer[i][FRONT_LEFT] += DryBuffer[i][FRONT_RIGHT];
+            }
+            aluConvertOutput(Layout, DryBuffer, buffer, SamplesToDo);
+            buffer = (ALubyte*)buffer +
+                     SamplesToDo*Layout->Channels*Layout->SampleSize;
         }
 
         size -= SamplesToDo;
     }
 
+#ifdef HAVE_SSE_CSR
+    _mm_setcsr(OldCSR);
+#endif
+
     ProcessContext(ALContext);
 }
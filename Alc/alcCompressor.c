@@ -0,0 +1,160 @@
+/**
+ * OpenAL cross platform audio library
+ * Copyright (C) 1999-2007 by authors.
+ * This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ *  License along with this library; if not, write to the
+ *  Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ *  Boston, MA  02111-1307, USA.
+ * Or go to http://www.gnu.org/copyleft/lgpl.html
+ */
+
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <math.h>
+
+#include "alMain.h"
+#include "alAuxEffectSlot.h"
+
+#define COMPRESSOR_CHUNK 256
+
+/* The envelope is followed every sample, but the gain is only worked out
+ * from it every this many samples, and ramped in between */
+#define COMPRESSOR_GAIN_STEP 32
+
+/* Level the gain is drawn toward, relative to full scale, and how far it
+ * may be raised or lowered */
+#define COMPRESSOR_TARGET   0.25f
+#define COMPRESSOR_MIN_GAIN 0.5f
+#define COMPRESSOR_MAX_GAIN 2.0f
+
+/* Envelope follower times, in seconds */
+#define COMPRESSOR_ATTACK   0.005f
+#define COMPRESSOR_RELEASE  0.2f
+
+/* Automatic gain control. The envelope of the input follows peaks quickly
+ * and falls back slowly, and the gain brings it halfway (in dB) to the
+ * target level, so quiet input is raised and loud input is lowered. */
+typedef struct ALcompressorState {
+    // Must be first in all effects!
+    ALeffectState state;
+
+    ALboolean Enabled;
+    ALfloat AttackRate;
+    ALfloat ReleaseRate;
+    ALfloat Envelope;
+    ALfloat Gain;
+} ALcompressorState;
+
+
+static ALvoid CompressorDestroy(ALeffectState *effect)
+{
+    free(effect);
+}
+
+static ALvoid CompressorUpdate(ALeffectState *effect, ALuint frequency, const ALeffect *Effect)
+{
+    ALcompressorState *State = (ALcompressorState*)effect;
+
+    State->Enabled = Effect->Compressor.OnOff;
+    State->AttackRate  = 1.0f - (ALfloat)exp(-1.0 / (COMPRESSOR_ATTACK*frequency));
+    State->ReleaseRate = 1.0f - (ALfloat)exp(-1.0 / (COMPRESSOR_RELEASE*frequency));
+}
+
+static ALvoid CompressorProcess(ALeffectState *effect, ALuint SamplesToDo, const ALfloat *SamplesIn, ALfloat (*SamplesOut)[OUTPUTCHANNELS])
+{
+    ALcompressorState *State = (ALcompressorState*)effect;
+    ALfloat Chunk[COMPRESSOR_CHUNK];
+    ALfloat env = State->Envelope;
+    ALfloat gain = State->Gain;
+    ALfloat amp, target, step;
+    ALuint base, todo, i, j, n;
+
+    for(base = 0;base < SamplesToDo;base += todo)
+    {
+        todo = min(SamplesToDo-base, COMPRESSOR_CHUNK);
+
+        if(State->Enabled)
+        {
+            for(i = 0;i < todo;i += n)
+            {
+                n = min(todo-i, COMPRESSOR_GAIN_STEP);
+
+                for(j = i;j < i+n;j++)
+                {
+                    // Samples are mixed at 16-bit scale
+                    amp = SamplesIn[base+j] * (1.0f/32768.0f);
+                    if(amp < 0.0f) amp = -amp;
+                    env += (amp-env) * ((amp > env) ? State->AttackRate :
+                                                      State->ReleaseRate);
+                }
+
+                target = COMPRESSOR_MAX_GAIN;
+                if(env > 0.0f)
+                {
+                    target = aluSqrt(COMPRESSOR_TARGET / env);
+                    target = min(target, COMPRESSOR_MAX_GAIN);
+                    target = max(target, COMPRESSOR_MIN_GAIN);
+                }
+
+                step = (target-gain) / n;
+                for(j = i;j < i+n;j++)
+                {
+                    gain += step;
+                    Chunk[j] = SamplesIn[base+j] * gain;
+                }
+                gain = target;
+            }
+        }
+        else
+        {
+            for(i = 0;i < todo;i++)
+                Chunk[i] = SamplesIn[base+i];
+        }
+
+        for(i = 0;i < todo;i++)
+        {
+            ALfloat *out = SamplesOut[base+i];
+
+            out[FRONT_LEFT]  += Chunk[i];
+            out[FRONT_RIGHT] += Chunk[i];
+            out[SIDE_LEFT]   += Chunk[i];
+            out[SIDE_RIGHT]  += Chunk[i];
+            out[BACK_LEFT]   += Chunk[i];
+            out[BACK_RIGHT]  += Chunk[i];
+        }
+    }
+
+    State->Envelope = aluFlushDenormal(env);
+    State->Gain = gain;
+}
+
+ALeffectState *CompressorCreate(ALuint frequency)
+{
+    ALcompressorState *State;
+
+    State = calloc(1, sizeof(*State));
+    if(!State)
+        return NULL;
+
+    State->state.Destroy = CompressorDestroy;
+    State->state.Update = CompressorUpdate;
+    State->state.Process = CompressorProcess;
+
+    // Silence gets the most gain
+    State->Gain = COMPRESSOR_MAX_GAIN;
+
+    (void)frequency;
+    return &State->state;
+}
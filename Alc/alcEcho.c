@@ -0,0 +1,168 @@
+/**
+ * OpenAL cross platform audio library
+ * Copyright (C) 1999-2007 by authors.
+ * This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ *  License along with this library; if not, write to the
+ *  Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ *  Boston, MA  02111-1307, USA.
+ * Or go to http://www.gnu.org/copyleft/lgpl.html
+ */
+
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <math.h>
+
+#include "alMain.h"
+#include "alAuxEffectSlot.h"
+
+#define ECHO_CHUNK 256
+
+/* Two taps on one delay line. The second tap follows the first by the LR
+ * delay, and is damped and fed back into the line. */
+typedef struct ALechoState {
+    // Must be first in all effects!
+    ALeffectState state;
+
+    // Sized for the longest delays allowed, so updates only move the taps
+    ALfloat *SampleBuffer;
+    ALuint BufferMask;
+    ALuint Pos;
+
+    ALuint Tap[2];
+    // Speaker gains of each tap, from the spread
+    ALfloat Gain[2][OUTPUTCHANNELS];
+
+    ALfloat FeedGain;
+    // Feedback lowpass, y = x*(1-Damping) + y[-1]*Damping
+    ALfloat Damping;
+    ALfloat Last;
+} ALechoState;
+
+
+static ALvoid EchoDestroy(ALeffectState *effect)
+{
+    ALechoState *State = (ALechoState*)effect;
+    if(State)
+    {
+        free(State->SampleBuffer);
+        free(State);
+    }
+}
+
+static ALvoid EchoUpdate(ALeffectState *effect, ALuint frequency, const ALeffect *Effect)
+{
+    ALechoState *State = (ALechoState*)effect;
+    ALfloat left, right;
+    ALuint c;
+
+    // Taps are at least a sample back, so the line is always read before
+    // the current sample is written
+    State->Tap[0] = (ALuint)(Effect->Echo.Delay * frequency) + 1;
+    State->Tap[1] = (ALuint)(Effect->Echo.LRDelay * frequency) + State->Tap[0];
+
+    State->FeedGain = Effect->Echo.Feedback;
+    State->Damping = Effect->Echo.Damping;
+
+    // A spread of -1 puts the first tap hard left and the second hard right,
+    // +1 swaps them, and 0 centers both
+    left  = (ALfloat)sqrt((1.0f-Effect->Echo.Spread) * 0.5f);
+    right = (ALfloat)sqrt((1.0f+Effect->Echo.Spread) * 0.5f);
+    for(c = 0;c < OUTPUTCHANNELS;c++)
+    {
+        State->Gain[0][c] = 0.0f;
+        State->Gain[1][c] = 0.0f;
+    }
+    State->Gain[0][FRONT_LEFT]  = State->Gain[0][SIDE_LEFT]  = State->Gain[0][BACK_LEFT]  = left;
+    State->Gain[0][FRONT_RIGHT] = State->Gain[0][SIDE_RIGHT] = State->Gain[0][BACK_RIGHT] = right;
+    State->Gain[1][FRONT_LEFT]  = State->Gain[1][SIDE_LEFT]  = State->Gain[1][BACK_LEFT]  = right;
+    State->Gain[1][FRONT_RIGHT] = State->Gain[1][SIDE_RIGHT] = State->Gain[1][BACK_RIGHT] = left;
+}
+
+static ALvoid EchoProcess(ALeffectState *effect, ALuint SamplesToDo, const ALfloat *SamplesIn, ALfloat (*SamplesOut)[OUTPUTCHANNELS])
+{
+    ALechoState *State = (ALechoState*)effect;
+    ALfloat *Buffer = State->SampleBuffer;
+    const ALuint mask = State->BufferMask;
+    const ALuint tap1 = State->Tap[0];
+    const ALuint tap2 = State->Tap[1];
+    const ALfloat feed = State->FeedGain;
+    const ALfloat damp = State->Damping;
+    ALfloat Taps[2][ECHO_CHUNK];
+    ALuint pos = State->Pos;
+    ALfloat last = State->Last;
+    ALfloat gain1, gain2;
+    ALuint base, todo, i, c;
+
+    // A chunk no longer than the shortest tap only reads samples written
+    // before it started, so the taps can be read for it up front
+    for(base = 0;base < SamplesToDo;base += todo)
+    {
+        todo = min(SamplesToDo-base, min(ECHO_CHUNK, tap1));
+
+        for(i = 0;i < todo;i++)
+            Taps[0][i] = Buffer[(pos+i-tap1)&mask];
+        for(i = 0;i < todo;i++)
+            Taps[1][i] = Buffer[(pos+i-tap2)&mask];
+
+        // Damped feedback of the second tap into the line
+        for(i = 0;i < todo;i++)
+        {
+            last = aluFlushDenormal(Taps[1][i]*(1.0f-damp) + last*damp);
+            Buffer[(pos+i)&mask] = SamplesIn[base+i] + last*feed;
+        }
+        pos += todo;
+
+        for(c = 0;c < OUTPUTCHANNELS;c++)
+        {
+            gain1 = State->Gain[0][c];
+            gain2 = State->Gain[1][c];
+            if(gain1 == 0.0f && gain2 == 0.0f)
+                continue;
+            for(i = 0;i < todo;i++)
+                SamplesOut[base+i][c] += Taps[0][i]*gain1 + Taps[1][i]*gain2;
+        }
+    }
+
+    State->Pos = pos & mask;
+    State->Last = last;
+}
+
+ALeffectState *EchoCreate(ALuint frequency)
+{
+    ALechoState *State;
+    ALuint size;
+
+    State = calloc(1, sizeof(*State));
+    if(!State)
+        return NULL;
+
+    State->state.Destroy = EchoDestroy;
+    State->state.Update = EchoUpdate;
+    State->state.Process = EchoProcess;
+
+    size = (ALuint)((AL_ECHO_MAX_DELAY+AL_ECHO_MAX_LRDELAY) * frequency) + 2;
+    State->BufferMask = 1;
+    while(State->BufferMask < size)
+        State->BufferMask <<= 1;
+    State->SampleBuffer = calloc(State->BufferMask, sizeof(ALfloat));
+    State->BufferMask--;
+    if(!State->SampleBuffer)
+    {
+        EchoDestroy(&State->state);
+        return NULL;
+    }
+
+    return &State->state;
+}
@@ -0,0 +1,186 @@
+/**
+ * OpenAL cross platform audio library
+ * Copyright (C) 1999-2007 by authors.
+ * This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ *  License along with this library; if not, write to the
+ *  Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ *  Boston, MA  02111-1307, USA.
+ * Or go to http://www.gnu.org/copyleft/lgpl.html
+ */
+
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <math.h>
+
+#include "alMain.h"
+#include "alAuxEffectSlot.h"
+#include "alFilter.h"
+
+#define EQ_CHUNK 256
+
+enum {
+    EQ_LOW = 0,
+    EQ_MID1,
+    EQ_MID2,
+    EQ_HIGH,
+
+    EQ_BANDS
+};
+
+/* Four biquads in series, a low shelf, two peaks and a high shelf. Bands
+ * left at unity gain are skipped. */
+typedef struct ALequalizerState {
+    // Must be first in all effects!
+    ALeffectState state;
+
+    ALbiquad Band[EQ_BANDS];
+    ALboolean BandOn[EQ_BANDS];
+    ALfloat History[EQ_BANDS][2];
+} ALequalizerState;
+
+
+/* Band coefficients from the Audio EQ Cookbook. The shelves have a slope of
+ * 1, and the peaks a width in octaves. */
+static ALvoid CalcBand(ALbiquad *f, ALuint band, ALfloat gain, ALfloat freq,
+                       ALfloat width, ALuint frequency)
+{
+    ALfloat w0, cw, sw, A, alpha, a0;
+
+    freq = min(freq, frequency*0.45f);
+    w0 = 2.0f*3.14159265358979323846f * freq / frequency;
+    cw = (ALfloat)cos(w0);
+    sw = (ALfloat)sin(w0);
+    A = (ALfloat)sqrt(gain);
+
+    switch(band)
+    {
+        case EQ_LOW:
+            alpha = sw/2.0f * (ALfloat)sqrt(2.0f);
+            a0    =          (A+1.0f) + (A-1.0f)*cw + 2.0f*(ALfloat)sqrt(A)*alpha;
+            f->a1 = -2.0f*  ((A-1.0f) + (A+1.0f)*cw);
+            f->a2 =          (A+1.0f) + (A-1.0f)*cw - 2.0f*(ALfloat)sqrt(A)*alpha;
+            f->b0 =     A*  ((A+1.0f) - (A-1.0f)*cw + 2.0f*(ALfloat)sqrt(A)*alpha);
+            f->b1 =  2.0f*A*((A-1.0f) - (A+1.0f)*cw);
+            f->b2 =     A*  ((A+1.0f) - (A-1.0f)*cw - 2.0f*(ALfloat)sqrt(A)*alpha);
+            break;
+        case EQ_HIGH:
+            alpha = sw/2.0f * (ALfloat)sqrt(2.0f);
+            a0    =          (A+1.0f) - (A-1.0f)*cw + 2.0f*(ALfloat)sqrt(A)*alpha;
+            f->a1 =  2.0f*  ((A-1.0f) - (A+1.0f)*cw);
+            f->a2 =          (A+1.0f) - (A-1.0f)*cw - 2.0f*(ALfloat)sqrt(A)*alpha;
+            f->b0 =     A*  ((A+1.0f) + (A-1.0f)*cw + 2.0f*(ALfloat)sqrt(A)*alpha);
+            f->b1 = -2.0f*A*((A-1.0f) + (A+1.0f)*cw);
+            f->b2 =     A*  ((A+1.0f) + (A-1.0f)*cw - 2.0f*(ALfloat)sqrt(A)*alpha);
+            break;
+        default:
+            alpha = sw * (ALfloat)sinh(log(2.0)/2.0 * width * w0/sw);
+            a0    =  1.0f + alpha/A;
+            f->a1 = -2.0f*cw;
+            f->a2 =  1.0f - alpha/A;
+            f->b0 =  1.0f + alpha*A;
+            f->b1 = -2.0f*cw;
+            f->b2 =  1.0f - alpha*A;
+            break;
+    }
+    f->a1 /= a0; f->a2 /= a0;
+    f->b0 /= a0; f->b1 /= a0; f->b2 /= a0;
+}
+
+static ALvoid EqualizerDestroy(ALeffectState *effect)
+{
+    free(effect);
+}
+
+static ALvoid EqualizerUpdate(ALeffectState *effect, ALuint frequency, const ALeffect *Effect)
+{
+    ALequalizerState *State = (ALequalizerState*)effect;
+    ALfloat gain[EQ_BANDS], freq[EQ_BANDS], width[EQ_BANDS];
+    ALuint b;
+
+    gain[EQ_LOW]  = Effect->Equalizer.LowGain;
+    freq[EQ_LOW]  = Effect->Equalizer.LowCutoff;
+    width[EQ_LOW] = 0.0f;
+    gain[EQ_MID1]  = Effect->Equalizer.Mid1Gain;
+    freq[EQ_MID1]  = Effect->Equalizer.Mid1Center;
+    width[EQ_MID1] = Effect->Equalizer.Mid1Width;
+    gain[EQ_MID2]  = Effect->Equalizer.Mid2Gain;
+    freq[EQ_MID2]  = Effect->Equalizer.Mid2Center;
+    width[EQ_MID2] = Effect->Equalizer.Mid2Width;
+    gain[EQ_HIGH]  = Effect->Equalizer.HighGain;
+    freq[EQ_HIGH]  = Effect->Equalizer.HighCutoff;
+    width[EQ_HIGH] = 0.0f;
+
+    for(b = 0;b < EQ_BANDS;b++)
+    {
+        ALboolean on = (gain[b] < 0.9999f || gain[b] > 1.0001f);
+
+        if(on)
+        {
+            CalcBand(&State->Band[b], b, gain[b], freq[b], width[b], frequency);
+            if(!State->BandOn[b])
+                State->History[b][0] = State->History[b][1] = 0.0f;
+        }
+        State->BandOn[b] = on;
+    }
+}
+
+static ALvoid EqualizerProcess(ALeffectState *effect, ALuint SamplesToDo, const ALfloat *SamplesIn, ALfloat (*SamplesOut)[OUTPUTCHANNELS])
+{
+    ALequalizerState *State = (ALequalizerState*)effect;
+    ALfloat Chunk[EQ_CHUNK];
+    ALuint base, todo, i, b;
+
+    for(base = 0;base < SamplesToDo;base += todo)
+    {
+        todo = min(SamplesToDo-base, EQ_CHUNK);
+
+        for(i = 0;i < todo;i++)
+            Chunk[i] = SamplesIn[base+i];
+        for(b = 0;b < EQ_BANDS;b++)
+        {
+            if(State->BandOn[b])
+                aluFilterBlock(&State->Band[b], &State->History[b][0],
+                               &State->History[b][1], Chunk, 1, 1, todo);
+        }
+
+        for(i = 0;i < todo;i++)
+        {
+            ALfloat *out = SamplesOut[base+i];
+
+            out[FRONT_LEFT]  += Chunk[i];
+            out[FRONT_RIGHT] += Chunk[i];
+            out[SIDE_LEFT]   += Chunk[i];
+            out[SIDE_RIGHT]  += Chunk[i];
+            out[BACK_LEFT]   += Chunk[i];
+            out[BACK_RIGHT]  += Chunk[i];
+        }
+    }
+}
+
+ALeffectState *EqualizerCreate(ALuint frequency)
+{
+    ALequalizerState *State;
+
+    State = calloc(1, sizeof(*State));
+    if(!State)
+        return NULL;
+
+    State->state.Destroy = EqualizerDestroy;
+    State->state.Update = EqualizerUpdate;
+    State->state.Process = EqualizerProcess;
+
+    (void)frequency;
+    return &State->state;
+}
@@ -0,0 +1,183 @@
+/**
+ * OpenAL cross platform audio library
+ * Copyright (C) 1999-2007 by authors.
+ * This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ *  License along with this library; if not, write to the
+ *  Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ *  Boston, MA  02111-1307, USA.
+ * Or go to http://www.gnu.org/copyleft/lgpl.html
+ */
+
+#include "config.h"
+
+#include <string.h>
+#include <stdlib.h>
+
+#include "alMain.h"
+#include "alu.h"
+
+
+/* A render queue mixes a playback device's output ahead of time on its own
+ * thread, one update at a time, into a ring the backend then copies from. A
+ * slow mix only eats into the lookahead instead of making the device
+ * underrun, at the cost of the lookahead in added latency. The render thread
+ * is the ring's only producer and the backend's I/O thread its only
+ * consumer. */
+struct RenderQueue {
+    ALCdevice *device;
+    RingBuffer *ring;
+
+    ALsizei frame_size;
+    // Frames mixed at once, the device's update size
+    ALuint block_size;
+    ALuint sleep_time;
+
+    volatile int killNow;
+    ALvoid *thread;
+};
+
+
+static ALuint RenderProc(ALvoid *ptr)
+{
+    RenderQueue *queue = (RenderQueue*)ptr;
+    ALCdevice *device = queue->device;
+    RingBufferRegion regions[2];
+    ALuint todo, len;
+    int i;
+
+    while(!queue->killNow)
+    {
+        if((ALuint)RingBufferSpace(queue->ring) < queue->block_size)
+        {
+            Sleep(queue->sleep_time);
+            continue;
+        }
+
+        // the free space may wrap around the end of the ring, in which case
+        // the block is mixed in two parts
+        PeekWriteRingBuffer(queue->ring, regions);
+        todo = queue->block_size;
+
+        SuspendContext(NULL);
+        for(i = 0;i < 2 && todo > 0;i++)
+        {
+            len = min(todo, (ALuint)regions[i].len);
+            aluMixData(device->Context, regions[i].ptr, len*queue->frame_size,
+                       device->Format);
+            todo -= len;
+        }
+        ProcessContext(NULL);
+
+        CommitWriteRingBuffer(queue->ring, queue->block_size);
+    }
+
+    return 0;
+}
+
+
+/* Starts mixing the device's output the given number of updates ahead. The
+ * backend must already be open, so the device's format and update size are
+ * final. */
+ALCboolean StartRenderQueue(ALCdevice *device, ALuint updates)
+{
+    RenderQueue *queue;
+
+    queue = calloc(1, sizeof(RenderQueue));
+    if(!queue)
+        return ALC_FALSE;
+
+    queue->device = device;
+    queue->frame_size = aluBytesFromFormat(device->Format) *
+                        aluChannelsFromFormat(device->Format);
+    queue->block_size = device->UpdateSize;
+    // wake up about four times per update to top the ring off
+    queue->sleep_time = max(queue->block_size*1000 / device->Frequency / 4, 1);
+
+    queue->ring = CreateRingBuffer(queue->frame_size, updates*queue->block_size);
+    if(!queue->ring)
+    {
+        free(queue);
+        return ALC_FALSE;
+    }
+
+    // publish the queue under the context lock, so a backend mixing inline
+    // switches over between two whole mixes
+    SuspendContext(NULL);
+    device->RenderQueue = queue;
+    ProcessContext(NULL);
+
+    queue->thread = StartThread(RenderProc, queue);
+    if(!queue->thread)
+    {
+        SuspendContext(NULL);
+        device->RenderQueue = NULL;
+        ProcessContext(NULL);
+
+        DestroyRingBuffer(queue->ring);
+        free(queue);
+        return ALC_FALSE;
+    }
+
+    return ALC_TRUE;
+}
+
+/* Stops the device's render queue, if it has one. The backend must be closed
+ * first, since it's no longer allowed to read from the queue. */
+ALCvoid StopRenderQueue(ALCdevice *device)
+{
+    RenderQueue *queue = device->RenderQueue;
+
+    if(!queue)
+        return;
+
+    queue->killNow = 1;
+    StopThread(queue->thread);
+
+    device->RenderQueue = NULL;
+    DestroyRingBuffer(queue->ring);
+    free(queue);
+}
+
+
+/* Fills the buffer with the next size bytes of the device's output. Without
+ * a render queue it mixes them right away; otherwise it copies what was
+ * mixed ahead, filling in silence if the render thread fell behind. Only the
+ * backend's I/O thread may call this. */
+ALvoid RenderDeviceData(ALCdevice *device, ALvoid *buffer, ALsizei size)
+{
+    RenderQueue *queue = device->RenderQueue;
+    ALsizei got;
+
+    if(!queue)
+    {
+        SuspendContext(NULL);
+        queue = device->RenderQueue;
+        if(!queue)
+        {
+            aluMixData(device->Context, buffer, size, device->Format);
+            ProcessContext(NULL);
+            return;
+        }
+        ProcessContext(NULL);
+    }
+
+    got = ReadRingBuffer(queue->ring, buffer, size / queue->frame_size);
+    got *= queue->frame_size;
+    if(got < size)
+    {
+        // 8-bit output is unsigned
+        memset((ALubyte*)buffer + got,
+               (aluBytesFromFormat(device->Format) == 1) ? 0x80 : 0,
+               size - got);
+    }
+}
@@ -0,0 +1,325 @@
+/**
+ * OpenAL cross platform audio library
+ * Copyright (C) 1999-2007 by authors.
+ * This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ *  License along with this library; if not, write to the
+ *  Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ *  Boston, MA  02111-1307, USA.
+ * Or go to http://www.gnu.org/copyleft/lgpl.html
+ */
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <math.h>
+
+#include "alMain.h"
+#include "alAuxEffectSlot.h"
+
+/* The reverb runs in chunks of at most this many samples. Every stage of a
+ * chunk is a separate loop over contiguous samples, so the compiler can
+ * vectorize the taps, the feedback matrix and the output mix. */
+#define REVERB_CHUNK 256
+
+#define EARLY_TAPS   4
+#define LATE_LINES   4
+
+/* Early reflection tap offsets after the reflections delay, and the lengths
+ * of the feedback delay network's lines, in seconds at full density. Lower
+ * densities stretch both by up to a third. */
+static const ALfloat EarlyTapTimes[EARLY_TAPS] = {
+    0.0000f, 0.0043f, 0.0097f, 0.0151f
+};
+static const ALfloat LateLineTimes[LATE_LINES] = {
+    0.0297f, 0.0371f, 0.0411f, 0.0437f
+};
+
+/* Tap positions and gains. Updates keep the previous set around so the next
+ * chunk can crossfade from it. */
+typedef struct ALverbTaps {
+    ALfloat Gain;
+
+    ALuint EarlyTap[EARLY_TAPS];
+    ALfloat EarlyGain;
+    ALuint LateTap;
+    ALfloat LateGain;
+
+    ALuint LineLength[LATE_LINES];
+} ALverbTaps;
+
+typedef struct ALverbState {
+    // Must be first in all effects!
+    ALeffectState state;
+
+    // Input delay line, read by the early reflection and late reverb taps.
+    // Sized for the longest delays allowed, so updates only move the taps
+    ALfloat *Delay;
+    ALuint DelayMask;
+    ALuint DelayPos;
+
+    ALverbTaps Taps;
+    ALverbTaps OldTaps;
+    ALboolean Fading;
+
+    // Feedback delay network lines, each LineMask+1 samples
+    ALfloat *Lines;
+    ALuint LineMask;
+    ALuint LinePos;
+    // Per-line decay lowpass, y = x*LineFeed + y[-1]*LineCoeff
+    ALfloat LineFeed[LATE_LINES];
+    ALfloat LineCoeff[LATE_LINES];
+    ALfloat LineLast[LATE_LINES];
+
+    // Largest chunk, no longer than the shortest line
+    ALuint MaxChunk;
+} ALverbState;
+
+
+static ALuint NextPowerOf2(ALuint value)
+{
+    ALuint ret = 1;
+    while(ret < value)
+        ret <<= 1;
+    return ret;
+}
+
+static __inline ALvoid ReadTaps(const ALfloat *Delay, ALuint mask, ALuint pos, const ALuint *taps, ALuint count, ALfloat gain, ALfloat *out, ALuint todo)
+{
+    ALuint tap, i, k;
+
+    tap = pos - taps[0];
+    for(i = 0;i < todo;i++)
+        out[i] = Delay[(tap+i)&mask];
+    for(k = 1;k < count;k++)
+    {
+        tap = pos - taps[k];
+        for(i = 0;i < todo;i++)
+            out[i] += Delay[(tap+i)&mask];
+    }
+    for(i = 0;i < todo;i++)
+        out[i] *= gain;
+}
+
+// Linear crossfade from old into out over the chunk
+static __inline ALvoid CrossFade(ALfloat *out, const ALfloat *old, ALuint todo)
+{
+    ALfloat step = 1.0f / todo;
+    ALuint i;
+
+    for(i = 0;i < todo;i++)
+        out[i] = old[i] + (out[i]-old[i])*(i*step);
+}
+
+static ALvoid ReverbDestroy(ALeffectState *effect)
+{
+    ALverbState *State = (ALverbState*)effect;
+    if(State)
+    {
+        free(State->Delay);
+        free(State->Lines);
+        free(State);
+    }
+}
+
+static ALvoid ReverbUpdate(ALeffectState *effect, ALuint frequency, const ALeffect *Effect)
+{
+    ALverbState *State = (ALverbState*)effect;
+    ALverbTaps *Taps = &State->Taps;
+    ALfloat scale, decay, decayHF, coeff;
+    ALuint i;
+
+    // Fade from whatever the last chunk played. If an earlier update hasn't
+    // been heard yet, it's simply replaced
+    if(!State->Fading)
+    {
+        State->OldTaps = State->Taps;
+        State->Fading = AL_TRUE;
+    }
+
+    scale = 1.0f + (1.0f-Effect->Reverb.Density)/3.0f;
+
+    for(i = 0;i < EARLY_TAPS;i++)
+        Taps->EarlyTap[i] = (ALuint)((Effect->Reverb.ReflectionsDelay +
+                                      EarlyTapTimes[i]*scale) * frequency);
+    Taps->LateTap = (ALuint)((Effect->Reverb.ReflectionsDelay +
+                              Effect->Reverb.LateReverbDelay) * frequency);
+
+    // Split the reflections over the taps and the late input over the lines
+    // at constant power
+    Taps->Gain = Effect->Reverb.Gain;
+    Taps->EarlyGain = Effect->Reverb.ReflectionsGain * 0.5f;
+    Taps->LateGain = Effect->Reverb.LateReverbGain * 0.5f;
+
+    for(i = 0;i < LATE_LINES;i++)
+    {
+        Taps->LineLength[i] = (ALuint)(LateLineTimes[i]*scale * frequency);
+
+        // Gain for one trip around the line to decay 60dB over the decay
+        // time, and a lowpass that shortens it at high frequencies by the
+        // HF ratio
+        decay = (ALfloat)pow(10.0, -3.0 * Taps->LineLength[i] /
+                                   (Effect->Reverb.DecayTime * frequency));
+        coeff = 0.0f;
+        if(Effect->Reverb.DecayHFRatio < 1.0f)
+        {
+            decayHF = (ALfloat)pow(decay, 1.0f/Effect->Reverb.DecayHFRatio);
+            coeff = (decay-decayHF) / (decay+decayHF);
+        }
+        State->LineCoeff[i] = coeff;
+        State->LineFeed[i] = decay * (1.0f-coeff);
+    }
+}
+
+static ALvoid ReverbProcess(ALeffectState *effect, ALuint SamplesToDo, const ALfloat *SamplesIn, ALfloat (*SamplesOut)[OUTPUTCHANNELS])
+{
+    ALverbState *State = (ALverbState*)effect;
+    ALfloat Early[REVERB_CHUNK];
+    ALfloat Late[REVERB_CHUNK];
+    ALfloat Fade[REVERB_CHUNK];
+    ALfloat Out[LATE_LINES][REVERB_CHUNK];
+    const ALverbTaps *Taps = &State->Taps;
+    const ALverbTaps *OldTaps = &State->OldTaps;
+    ALfloat *Delay = State->Delay;
+    ALuint DelayMask = State->DelayMask;
+    ALuint LineMask = State->LineMask;
+    ALuint LineSize = LineMask+1;
+    ALuint base, todo, tap, i, k;
+    ALfloat last, sum;
+
+    for(base = 0;base < SamplesToDo;base += todo)
+    {
+        todo = min(SamplesToDo-base, State->MaxChunk);
+
+        for(i = 0;i < todo;i++)
+            Fade[i] = SamplesIn[base+i] * OldTaps->Gain;
+        for(i = 0;i < todo;i++)
+            Early[i] = SamplesIn[base+i] * Taps->Gain;
+        if(State->Fading)
+            CrossFade(Early, Fade, todo);
+        for(i = 0;i < todo;i++)
+            Delay[(State->DelayPos+i)&DelayMask] = Early[i];
+
+        ReadTaps(Delay, DelayMask, State->DelayPos, Taps->EarlyTap, EARLY_TAPS,
+                 Taps->EarlyGain, Early, todo);
+        ReadTaps(Delay, DelayMask, State->DelayPos, &Taps->LateTap, 1,
+                 Taps->LateGain, Late, todo);
+        if(State->Fading)
+        {
+            ReadTaps(Delay, DelayMask, State->DelayPos, OldTaps->EarlyTap,
+                     EARLY_TAPS, OldTaps->EarlyGain, Fade, todo);
+            CrossFade(Early, Fade, todo);
+            ReadTaps(Delay, DelayMask, State->DelayPos, &OldTaps->LateTap, 1,
+                     OldTaps->LateGain, Fade, todo);
+            CrossFade(Late, Fade, todo);
+        }
+
+        // Chunks are never longer than the shortest line, so the whole
+        // chunk's line outputs were written by earlier chunks
+        for(k = 0;k < LATE_LINES;k++)
+        {
+            const ALfloat *Line = State->Lines + k*LineSize;
+            ALfloat feed = State->LineFeed[k];
+            ALfloat coeff = State->LineCoeff[k];
+
+            tap = State->LinePos - Taps->LineLength[k];
+            for(i = 0;i < todo;i++)
+                Out[k][i] = Line[(tap+i)&LineMask];
+            if(State->Fading)
+            {
+                tap = State->LinePos - OldTaps->LineLength[k];
+                for(i = 0;i < todo;i++)
+                    Fade[i] = Line[(tap+i)&LineMask];
+                CrossFade(Out[k], Fade, todo);
+            }
+
+            last = State->LineLast[k];
+            for(i = 0;i < todo;i++)
+            {
+                // The late reverb rings forever after its input stops, so
+                // flush each sample before it goes back in the line
+                last = aluFlushDenormal(Out[k][i]*feed + last*coeff);
+                Out[k][i] = last;
+            }
+            State->LineLast[k] = last;
+        }
+        State->Fading = AL_FALSE;
+        // Householder feedback matrix, I - 2/N
+        for(i = 0;i < todo;i++)
+        {
+            ALuint pos = (State->LinePos+i) & LineMask;
+
+            sum = (Out[0][i] + Out[1][i] + Out[2][i] + Out[3][i]) * 0.5f;
+            State->Lines[0*LineSize + pos] = Out[0][i] - sum + Late[i];
+            State->Lines[1*LineSize + pos] = Out[1][i] - sum + Late[i];
+            State->Lines[2*LineSize + pos] = Out[2][i] - sum + Late[i];
+            State->Lines[3*LineSize + pos] = Out[3][i] - sum + Late[i];
+        }
+
+        // The early reflections go to every speaker, while each speaker
+        // pair gets different lines so the late reverb stays decorrelated
+        for(i = 0;i < todo;i++)
+        {
+            ALfloat *out = SamplesOut[base+i];
+
+            out[FRONT_LEFT]  += Early[i] + Out[0][i];
+            out[FRONT_RIGHT] += Early[i] + Out[1][i];
+            out[SIDE_LEFT]   += Early[i] + Out[2][i];
+            out[SIDE_RIGHT]  += Early[i] + Out[3][i];
+            out[BACK_LEFT]   += Early[i] + Out[3][i];
+            out[BACK_RIGHT]  += Early[i] + Out[2][i];
+        }
+
+        State->DelayPos = (State->DelayPos+todo) & DelayMask;
+        State->LinePos = (State->LinePos+todo) & LineMask;
+    }
+}
+
+ALeffectState *ReverbCreate(ALuint frequency)
+{
+    ALverbState *State;
+    ALuint size;
+
+    State = calloc(1, sizeof(*State));
+    if(!State)
+        return NULL;
+
+    State->state.Destroy = ReverbDestroy;
+    State->state.Update = ReverbUpdate;
+    State->state.Process = ReverbProcess;
+
+    State->MaxChunk = (ALuint)(LateLineTimes[0] * frequency);
+    State->MaxChunk = min(State->MaxChunk, REVERB_CHUNK);
+    State->MaxChunk = max(State->MaxChunk, 1);
+
+    // The furthest tap is the last early reflection at the lowest density
+    // or the late reverb, plus one chunk
+    size = (ALuint)((AL_REVERB_MAX_REFLECTIONS_DELAY +
+                     max(EarlyTapTimes[EARLY_TAPS-1] * 4.0f/3.0f,
+                         AL_REVERB_MAX_LATE_REVERB_DELAY)) * frequency);
+    size = NextPowerOf2(size + State->MaxChunk + 1);
+    State->Delay = calloc(size, sizeof(ALfloat));
+    State->DelayMask = size-1;
+
+    size = (ALuint)(LateLineTimes[LATE_LINES-1] * 4.0f/3.0f * frequency) + 1;
+    size = NextPowerOf2(size);
+    State->Lines = calloc(size*LATE_LINES, sizeof(ALfloat));
+    State->LineMask = size-1;
+
+    if(!State->Delay || !State->Lines)
+    {
+        ReverbDestroy(&State->state);
+        return NULL;
+    }
+
+    return &State->state;
+}
@@ -26,15 +26,54 @@
 #include "alMain.h"
 
 
+/* The ring is single-producer/single-consumer and takes no locks. The read
+ * and write positions are free-running frame counters; only the producer
+ * stores write_pos and only the consumer stores read_pos. Each side publishes
+ * its position with a release store after touching the frames, and reads the
+ * other side's with an acquire load before touching them, so the frames
+ * themselves never need further synchronization. The memory is a power of two
+ * in frames, so positions wrap into it with a mask. */
+#if defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7))
+#define LoadAcquire(ptr)        __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#define StoreRelease(ptr, val)  __atomic_store_n((ptr), (val), __ATOMIC_RELEASE)
+#elif defined(__GNUC__)
+static __inline ALuint LoadAcquire(volatile ALuint *ptr)
+{
+    ALuint val = *ptr;
+    __sync_synchronize();
+    return val;
+}
+static __inline void StoreRelease(volatile ALuint *ptr, ALuint val)
+{
+    __sync_synchronize();
+    *ptr = val;
+}
+#elif defined(_WIN32)
+static __inline ALuint LoadAcquire(volatile ALuint *ptr)
+{
+    ALuint val = *ptr;
+    MemoryBarrier();
+    return val;
+}
+static __inline void StoreRelease(volatile ALuint *ptr, ALuint val)
+{
+    MemoryBarrier();
+    *ptr = val;
+}
+#else
+#error "No memory barriers for this compiler"
+#endif
+
 struct RingBuffer {
     ALubyte *mem;
 
     ALsizei frame_size;
-    ALsizei length;
-    ALint read_pos;
-    ALint write_pos;
+    ALuint size_mask;
+    // Frames the ring may hold, as requested; the memory may be larger
+    ALuint length;
 
-    CRITICAL_SECTION cs;
+    volatile ALuint read_pos;
+    volatile ALuint write_pos;
 };
 
 
@@ -43,17 +82,19 @@ RingBuffer *CreateRingBuffer(ALsizei frame_size, ALsizei length)
     RingBuffer *ring = calloc(1, sizeof(*ring));
     if(ring)
     {
+        ALuint power = 1;
+        while(power < (ALuint)length)
+            power <<= 1;
+
         ring->frame_size = frame_size;
-        ring->length = length+1;
-        ring->write_pos = 1;
-        ring->mem = malloc((length+1)*frame_size);
+        ring->size_mask = power-1;
+        ring->length = length;
+        ring->mem = malloc(power*frame_size);
         if(!ring->mem)
         {
             free(ring);
             ring = NULL;
         }
-
-        InitializeCriticalSection(&ring->cs);
     }
     return ring;
 }
@@ -62,57 +103,98 @@ void DestroyRingBuffer(RingBuffer *ring)
 {
     if(ring)
     {
-        DeleteCriticalSection(&ring->cs);
         free(ring->mem);
         free(ring);
     }
 }
 
+/* Frames available to read. Only valid from the consumer */
 ALsizei RingBufferSize(RingBuffer *ring)
 {
-    return (ring->write_pos-ring->read_pos-1+ring->length) % ring->length;
+    return LoadAcquire(&ring->write_pos) - ring->read_pos;
 }
 
-void WriteRingBuffer(RingBuffer *ring, const ALubyte *data, ALsizei len)
+/* Frames that can be written. Only valid from the producer */
+ALsizei RingBufferSpace(RingBuffer *ring)
 {
-    int remain = ring->length - ring->write_pos;
-
-    EnterCriticalSection(&ring->cs);
+    return ring->length - (ring->write_pos - LoadAcquire(&ring->read_pos));
+}
 
-    if((ring->read_pos-ring->write_pos+ring->length)%ring->length < len)
-        ring->read_pos = (ring->write_pos+len) % ring->length;
 
-    if(remain < len)
-    {
-        memcpy(ring->mem+(ring->write_pos*ring->frame_size), data, remain*ring->frame_size);
-        memcpy(ring->mem, data+(remain*ring->frame_size), (len-remain)*ring->frame_size);
-    }
-    else
-        memcpy(ring->mem+(ring->write_pos*ring->frame_size), data, len*ring->frame_size);
+/* Gives the (up to two) regions of the ring that can be written to directly,
+ * and returns their total length in frames. Nothing is written until
+ * CommitWriteRingBuffer is called. */
+ALsizei PeekWriteRingBuffer(RingBuffer *ring, RingBufferRegion regions[2])
+{
+    ALuint space = RingBufferSpace(ring);
+    ALuint pos = ring->write_pos & ring->size_mask;
+    ALuint len1 = min(space, ring->size_mask+1 - pos);
+
+    regions[0].ptr = ring->mem + pos*ring->frame_size;
+    regions[0].len = len1;
+    regions[1].ptr = ring->mem;
+    regions[1].len = space - len1;
+    return space;
+}
 
-    ring->write_pos += len;
-    ring->write_pos %= ring->length;
+void CommitWriteRingBuffer(RingBuffer *ring, ALsizei len)
+{
+    StoreRelease(&ring->write_pos, ring->write_pos + len);
+}
 
-    LeaveCriticalSection(&ring->cs);
+/* Gives the (up to two) regions of the ring that can be read from directly,
+ * and returns their total length in frames. The frames stay in the ring until
+ * CommitReadRingBuffer is called. */
+ALsizei PeekReadRingBuffer(RingBuffer *ring, RingBufferRegion regions[2])
+{
+    ALuint avail = RingBufferSize(ring);
+    ALuint pos = ring->read_pos & ring->size_mask;
+    ALuint len1 = min(avail, ring->size_mask+1 - pos);
+
+    regions[0].ptr = ring->mem + pos*ring->frame_size;
+    regions[0].len = len1;
+    regions[1].ptr = ring->mem;
+    regions[1].len = avail - len1;
+    return avail;
 }
 
-void ReadRingBuffer(RingBuffer *ring, ALubyte *data, ALsizei len)
+void CommitReadRingBuffer(RingBuffer *ring, ALsizei len)
 {
-    int remain = ring->length - ring->read_pos;
+    StoreRelease(&ring->read_pos, ring->read_pos + len);
+}
 
-    EnterCriticalSection(&ring->cs);
 
-    if(remain < len)
-    {
-        memcpy(data, ring->mem+(ring->read_pos*ring->frame_size), remain*ring->frame_size);
-        memcpy(data+(remain*ring->frame_size), ring->mem, (len-remain)*ring->frame_size);
-    }
-    else
-        memcpy(data, ring->mem+(ring->read_pos*ring->frame_size), len*ring->frame_size);
+/* Copies in up to len frames and returns how many fit. Frames that don't fit
+ * are dropped; the producer can't make room without racing the consumer. */
+ALsizei WriteRingBuffer(RingBuffer *ring, const ALubyte *data, ALsizei len)
+{
+    RingBufferRegion regions[2];
+    ALsizei avail, len1;
+
+    avail = PeekWriteRingBuffer(ring, regions);
+    len = min(len, avail);
+    len1 = min(len, regions[0].len);
 
-    ring->read_pos += len;
-    ring->read_pos %= ring->length;
+    memcpy(regions[0].ptr, data, len1*ring->frame_size);
+    memcpy(regions[1].ptr, data+len1*ring->frame_size, (len-len1)*ring->frame_size);
 
-    LeaveCriticalSection(&ring->cs);
+    CommitWriteRingBuffer(ring, len);
+    return len;
 }
 
+/* Copies out up to len frames and returns how many there were */
+ALsizei ReadRingBuffer(RingBuffer *ring, ALubyte *data, ALsizei len)
+{
+    RingBufferRegion regions[2];
+    ALsizei avail, len1;
+
+    avail = PeekReadRingBuffer(ring, regions);
+    len = min(len, avail);
+    len1 = min(len, regions[0].len);
+
+    memcpy(data, regions[0].ptr, len1*ring->frame_size);
+    memcpy(data+len1*ring->frame_size, regions[1].ptr, (len-len1)*ring->frame_size);
+
+    CommitReadRingBuffer(ring, len);
+    return len;
+}
@@ -20,12 +20,53 @@
 
 #include "config.h"
 
+#ifdef HAVE_PTHREAD_SETAFFINITY_NP
+/* For pthread_setaffinity_np and the CPU_* macros */
+#define _GNU_SOURCE 1
+#endif
+
 #include <stdlib.h>
+#include <ctype.h>
 
 #include "alMain.h"
 #include "alThunk.h"
 
 
+/* Reads the next CPU or CPU range from a list like "0,2-3", returning where
+ * to continue from, or NULL at the end or on a malformed entry */
+static const char *NextCPURange(const char *str, int *first, int *last)
+{
+    char *end;
+
+    while(isspace(*str) || *str == ',')
+        str++;
+    if(!*str)
+        return NULL;
+
+    *first = *last = strtol(str, &end, 10);
+    if(end == str || *first < 0)
+        return NULL;
+    str = end;
+    if(*str == '-')
+    {
+        *last = strtol(str+1, &end, 10);
+        if(end == str+1 || *last < *first)
+            return NULL;
+        str = end;
+    }
+    return str;
+}
+
+static ALboolean GetConfigBool(const char *key)
+{
+    const char *str = GetConfigValue(NULL, key, "false");
+    return (strcasecmp(str, "true") == 0 ||
+            strcasecmp(str, "yes") == 0 ||
+            strcasecmp(str, "on") == 0 ||
+            atoi(str) != 0);
+}
+
+
 #ifdef _WIN32
 
 typedef struct {
@@ -34,11 +75,42 @@ typedef struct {
     HANDLE thread;
 } ThreadInfo;
 
+/* Applies the rt-prio, cpu-affinity and mlock settings to the calling thread.
+ * Anything that isn't permitted is reported and skipped. */
+void SetMixerThreadAttributes(void)
+{
+    const char *str;
+    int first, last;
+
+    if(GetConfigValueInt(NULL, "rt-prio", 0) > 0)
+    {
+        if(!SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL))
+            AL_PRINT("Could not raise thread priority: %lu\n", GetLastError());
+    }
+
+    str = GetConfigValue(NULL, "cpu-affinity", "");
+    if(str[0])
+    {
+        DWORD_PTR mask = 0;
+        while((str=NextCPURange(str, &first, &last)) != NULL)
+        {
+            for(;first <= last && first < (int)sizeof(mask)*8;first++)
+                mask |= (DWORD_PTR)1 << first;
+        }
+        if(!mask || !SetThreadAffinityMask(GetCurrentThread(), mask))
+            AL_PRINT("Could not set CPU affinity: %lu\n", GetLastError());
+    }
+
+    if(GetConfigBool("mlock"))
+        aluLockMixBuffers();
+}
+
 static DWORD CALLBACK StarterFunc(void *ptr)
 {
     ThreadInfo *inf = (ThreadInfo*)ptr;
     ALint ret;
 
+    SetMixerThreadAttributes();
     ret = inf->func(inf->ptr);
     ExitThread((DWORD)ret);
 
@@ -79,6 +151,9 @@ ALuint StopThread(ALvoid *thread)
 #else
 
 #include <pthread.h>
+#include <sched.h>
+#include <errno.h>
+#include <sys/resource.h>
 
 typedef struct {
     ALuint (*func)(ALvoid*);
@@ -86,11 +161,82 @@ typedef struct {
     pthread_t thread;
 } ThreadInfo;
 
+/* Applies the rt-prio, cpu-affinity and mlock settings to the calling thread.
+ * Anything that isn't permitted is reported and skipped, leaving the thread
+ * as it was. */
+void SetMixerThreadAttributes(void)
+{
+    int prio = GetConfigValueInt(NULL, "rt-prio", 0);
+    const char *str;
+    int first, last;
+    int err;
+
+    if(prio > 0)
+    {
+        struct sched_param param;
+        int policy = SCHED_FIFO;
+
+        str = GetConfigValue(NULL, "rt-policy", "fifo");
+        if(strcasecmp(str, "rr") == 0)
+            policy = SCHED_RR;
+        prio = max(prio, sched_get_priority_min(policy));
+        prio = min(prio, sched_get_priority_max(policy));
+
+#ifdef RLIMIT_RTPRIO
+        {
+            /* Unprivileged users may still be granted real-time priorities
+             * through the hard limit (e.g. limits.conf), but the soft limit
+             * must be raised before they can be used */
+            struct rlimit rlim;
+            if(getrlimit(RLIMIT_RTPRIO, &rlim) == 0 && rlim.rlim_cur < (rlim_t)prio &&
+               rlim.rlim_cur < rlim.rlim_max)
+            {
+                rlim.rlim_cur = min(rlim.rlim_max, (rlim_t)prio);
+                setrlimit(RLIMIT_RTPRIO, &rlim);
+            }
+        }
+#endif
+
+        param.sched_priority = prio;
+        err = pthread_setschedparam(pthread_self(), policy, &param);
+        if(err != 0)
+            AL_PRINT("Could not set real-time priority %d: %s\n", prio, strerror(err));
+    }
+
+    str = GetConfigValue(NULL, "cpu-affinity", "");
+    if(str[0])
+    {
+#ifdef HAVE_PTHREAD_SETAFFINITY_NP
+        cpu_set_t cpus;
+        int count = 0;
+
+        CPU_ZERO(&cpus);
+        while((str=NextCPURange(str, &first, &last)) != NULL)
+        {
+            for(;first <= last && first < CPU_SETSIZE;first++,count++)
+                CPU_SET(first, &cpus);
+        }
+        if(count == 0)
+            AL_PRINT("No usable CPUs in cpu-affinity\n");
+        else if((err=pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus)) != 0)
+            AL_PRINT("Could not set CPU affinity: %s\n", strerror(err));
+#else
+        (void)first;
+        (void)last;
+        AL_PRINT("CPU affinity not supported\n");
+#endif
+    }
+
+    if(GetConfigBool("mlock"))
+        aluLockMixBuffers();
+}
+
 static void *StarterFunc(void *ptr)
 {
     ThreadInfo *inf = (ThreadInfo*)ptr;
     ALint ret;
 
+    SetMixerThreadAttributes();
     ret = inf->func(inf->ptr);
     return (void*)ret;
 }
@@ -23,6 +23,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <memory.h>
+#include <poll.h>
 #ifdef HAVE_DLFCN_H
 #include <dlfcn.h>
 #endif
@@ -40,6 +41,12 @@ typedef struct {
     ALvoid *buffer;
     ALsizei size;
 
+    // Capture only
+    RingBuffer *ring;
+    struct pollfd *pfds;
+    int npfds;
+    volatile int doCapture;
+
     int killNow;
     ALvoid *thread;
 } alsa_data;
@@ -67,9 +74,15 @@ MAKE_FUNC(snd_pcm_hw_params_set_rate_near);
 MAKE_FUNC(snd_pcm_hw_params_set_rate);
 MAKE_FUNC(snd_pcm_hw_params_set_buffer_size_near);
 MAKE_FUNC(snd_pcm_hw_params_set_buffer_size_min);
+MAKE_FUNC(snd_pcm_hw_params_set_period_size_near);
 MAKE_FUNC(snd_pcm_hw_params_get_period_size);
 MAKE_FUNC(snd_pcm_hw_params_get_access);
 MAKE_FUNC(snd_pcm_hw_params);
+MAKE_FUNC(snd_pcm_sw_params_malloc);
+MAKE_FUNC(snd_pcm_sw_params_free);
+MAKE_FUNC(snd_pcm_sw_params_current);
+MAKE_FUNC(snd_pcm_sw_params_set_avail_min);
+MAKE_FUNC(snd_pcm_sw_params);
 MAKE_FUNC(snd_pcm_prepare);
 MAKE_FUNC(snd_pcm_start);
 MAKE_FUNC(snd_pcm_resume);
@@ -80,7 +93,13 @@ MAKE_FUNC(snd_pcm_areas_silence);
 MAKE_FUNC(snd_pcm_mmap_begin);
 MAKE_FUNC(snd_pcm_mmap_commit);
 MAKE_FUNC(snd_pcm_writei);
+MAKE_FUNC(snd_pcm_readi);
+MAKE_FUNC(snd_pcm_delay);
+MAKE_FUNC(snd_pcm_drop);
 MAKE_FUNC(snd_pcm_drain);
+MAKE_FUNC(snd_pcm_poll_descriptors_count);
+MAKE_FUNC(snd_pcm_poll_descriptors);
+MAKE_FUNC(snd_pcm_poll_descriptors_revents);
 MAKE_FUNC(snd_pcm_info_malloc);
 MAKE_FUNC(snd_pcm_info_free);
 MAKE_FUNC(snd_pcm_info_set_device);
@@ -172,8 +191,8 @@ static ALuint ALSAProc(ALvoid *ptr)
             }
         }
 
-        // make sure there's frames to process
-        if(avail == 0)
+        // wait until there's room for a whole period
+        if(avail < (snd_pcm_sframes_t)pDevice->UpdateSize)
         {
             if(state != SND_PCM_STATE_RUNNING)
             {
@@ -191,35 +210,44 @@ static ALuint ALSAProc(ALvoid *ptr)
             continue;
         }
 
-        // it is possible that contiguous areas are smaller, thus we use a loop
+        // mix exactly one period at a time, so every update costs the same;
+        // more than one only happens when catching up after a stall
+        avail -= avail%pDevice->UpdateSize;
         while (avail > 0)
         {
-            frames = avail;
-
-            err = psnd_pcm_mmap_begin(data->pcmHandle, &areas, &offset, &frames);
-            if (err < 0)
+            // it is possible that contiguous areas are smaller, thus we use a loop
+            snd_pcm_uframes_t todo = pDevice->UpdateSize;
+            while (todo > 0)
             {
-                err = xrun_recovery(data->pcmHandle, err);
+                frames = todo;
+
+                err = psnd_pcm_mmap_begin(data->pcmHandle, &areas, &offset, &frames);
                 if (err < 0)
-                    AL_PRINT("mmap begin error: %s\n", psnd_strerror(err));
-                break;
-            }
+                {
+                    err = xrun_recovery(data->pcmHandle, err);
+                    if (err < 0)
+                        AL_PRINT("mmap begin error: %s\n", psnd_strerror(err));
+                    break;
+                }
 
-            SuspendContext(NULL);
-            WritePtr = (char*)areas->addr + (offset * areas->step / 8);
-            WriteCnt = psnd_pcm_frames_to_bytes(data->pcmHandle, frames);
-            aluMixData(pDevice->Context, WritePtr, WriteCnt, pDevice->Format);
-            ProcessContext(NULL);
+                WritePtr = (char*)areas->addr + (offset * areas->step / 8);
+                WriteCnt = psnd_pcm_frames_to_bytes(data->pcmHandle, frames);
+                RenderDeviceData(pDevice, WritePtr, WriteCnt);
 
-            commitres = psnd_pcm_mmap_commit(data->pcmHandle, offset, frames);
-            if (commitres < 0 || (commitres-frames) != 0)
-            {
-                AL_PRINT("mmap commit error: %s\n",
-                         psnd_strerror(commitres >= 0 ? -EPIPE : commitres));
-                break;
+                commitres = psnd_pcm_mmap_commit(data->pcmHandle, offset, frames);
+                if (commitres < 0 || (commitres-frames) != 0)
+                {
+                    AL_PRINT("mmap commit error: %s\n",
+                             psnd_strerror(commitres >= 0 ? -EPIPE : commitres));
+                    break;
+                }
+
+                todo -= frames;
             }
+            if (todo > 0)
+                break;
 
-            avail -= frames;
+            avail -= pDevice->UpdateSize;
         }
     }
 
@@ -235,9 +263,7 @@ static ALuint ALSANoMMapProc(ALvoid *ptr)
 
     while(!data->killNow)
     {
-        SuspendContext(NULL);
-        aluMixData(pDevice->Context, data->buffer, data->size, pDevice->Format);
-        ProcessContext(NULL);
+        RenderDeviceData(pDevice, data->buffer, data->size);
 
         WritePtr = data->buffer;
         avail = (snd_pcm_uframes_t)data->size / psnd_pcm_frames_to_bytes(data->pcmHandle, 1);
@@ -274,10 +300,108 @@ static ALuint ALSANoMMapProc(ALvoid *ptr)
     return 0;
 }
 
+/* Capture runs on its own thread, which sleeps in poll() until the device has
+ * a period ready and then reads it straight into the ring. The app's calls
+ * only ever copy out of the ring, and never touch the PCM. Starting and
+ * stopping is also done here, as the PCM handle isn't safe to share between
+ * threads. */
+static ALuint ALSACaptureProc(ALvoid *ptr)
+{
+    ALCdevice *pDevice = (ALCdevice*)ptr;
+    alsa_data *data = (alsa_data*)pDevice->ExtraData;
+    snd_pcm_sframes_t avail, amt, delay;
+    unsigned short revents;
+    snd_pcm_state_t state;
+    int err;
+
+    while(!data->killNow)
+    {
+        state = psnd_pcm_state(data->pcmHandle);
+        if(!data->doCapture)
+        {
+            if(state == SND_PCM_STATE_RUNNING || state == SND_PCM_STATE_XRUN)
+                psnd_pcm_drop(data->pcmHandle);
+            Sleep(10);
+            continue;
+        }
+        if(state == SND_PCM_STATE_SETUP || state == SND_PCM_STATE_PREPARED ||
+           state == SND_PCM_STATE_XRUN || state == SND_PCM_STATE_SUSPENDED)
+        {
+            if(state == SND_PCM_STATE_XRUN)
+                pDevice->CaptureOverruns++;
+            err = xrun_recovery(data->pcmHandle, (state == SND_PCM_STATE_SUSPENDED) ? -ESTRPIPE : -EPIPE);
+            if(err >= 0)
+                err = psnd_pcm_start(data->pcmHandle);
+            if(err < 0)
+            {
+                AL_PRINT("start failed: %s\n", psnd_strerror(err));
+                break;
+            }
+        }
+
+        // the timeout only bounds how long a stop or close can take
+        err = poll(data->pfds, data->npfds, 100);
+        if(err < 0)
+        {
+            if(errno == EINTR)
+                continue;
+            AL_PRINT("poll failed: %s\n", strerror(errno));
+            break;
+        }
+        if(err == 0)
+            continue;
+        if(psnd_pcm_poll_descriptors_revents(data->pcmHandle, data->pfds, data->npfds, &revents) < 0 ||
+           !(revents&(POLLIN|POLLERR)))
+            continue;
+
+        avail = psnd_pcm_avail_update(data->pcmHandle);
+        if(avail < 0)
+        {
+            // handled by the state check next time around
+            continue;
+        }
+
+        while(avail > 0)
+        {
+            RingBufferRegion regions[2];
+
+            PeekWriteRingBuffer(data->ring, regions);
+            if(regions[0].len > 0)
+            {
+                amt = psnd_pcm_readi(data->pcmHandle, regions[0].ptr, min(avail, regions[0].len));
+                if(amt > 0)
+                    CommitWriteRingBuffer(data->ring, amt);
+            }
+            else
+            {
+                // the app isn't keeping up; drop what the device has rather
+                // than letting it overrun
+                amt = psnd_pcm_readi(data->pcmHandle, data->buffer, min(avail, data->size));
+                pDevice->CaptureOverruns++;
+            }
+            if(amt < 0)
+            {
+                if(xrun_recovery(data->pcmHandle, amt) >= 0)
+                    psnd_pcm_start(data->pcmHandle);
+                pDevice->CaptureOverruns++;
+                break;
+            }
+            avail -= amt;
+        }
+
+        if(psnd_pcm_delay(data->pcmHandle, &delay) >= 0)
+            pDevice->CaptureDelay = max(delay, 0);
+    }
+
+    return 0;
+}
+
 static ALCboolean alsa_open_playback(ALCdevice *device, const ALCchar *deviceName)
 {
     snd_pcm_uframes_t bufferSizeInFrames;
+    snd_pcm_uframes_t periodSizeInFrames;
     snd_pcm_hw_params_t *p = NULL;
+    snd_pcm_sw_params_t *sp = NULL;
     snd_pcm_access_t access;
     unsigned int periods;
     alsa_data *data;
@@ -353,13 +477,29 @@ open_alsa:
         case 2:
             data->format = SND_PCM_FORMAT_S16;
             break;
+        case 4:
+            data->format = SND_PCM_FORMAT_FLOAT;
+            break;
         default:
             data->format = SND_PCM_FORMAT_UNKNOWN;
             AL_PRINT("Unknown format?! %x\n", device->Format);
     }
 
+    /* The period size, when set, is what gets mixed per update. The buffer
+     * size defaults to a few periods then, and to the refresh size if
+     * neither is set */
     periods = GetConfigValueInt("alsa", "periods", 0);
-    bufferSizeInFrames = device->UpdateSize;
+    i = GetConfigValueInt("alsa", "period_size", 0);
+    periodSizeInFrames = max(i, 0);
+    i = GetConfigValueInt("alsa", "buffer_size", 0);
+    bufferSizeInFrames = max(i, 0);
+    if(!bufferSizeInFrames)
+    {
+        if(periodSizeInFrames)
+            bufferSizeInFrames = periodSizeInFrames * (periods ? periods : 3);
+        else
+            bufferSizeInFrames = device->UpdateSize;
+    }
 
     str = GetConfigValue("alsa", "mmap", "true");
     allowmmap = (strcasecmp(str, "true") == 0 ||
@@ -382,6 +522,8 @@ open_alsa:
          (!periods || ok(psnd_pcm_hw_params_set_periods_near(data->pcmHandle, p, &periods, NULL), "set periods near")) &&
          /* set rate (implicitly constrains period/buffer parameters) */
          ok(psnd_pcm_hw_params_set_rate_near(data->pcmHandle, p, &device->Frequency, NULL), "set rate near") &&
+         /* set period size in frame units, if requested */
+         (!periodSizeInFrames || ok(psnd_pcm_hw_params_set_period_size_near(data->pcmHandle, p, &periodSizeInFrames, NULL), "set period size near")) &&
          /* set buffer size in frame units (implicitly sets period size/bytes/time and buffer time/bytes) */
          ok(psnd_pcm_hw_params_set_buffer_size_near(data->pcmHandle, p, &bufferSizeInFrames), "set buffer size near") &&
          /* install and prepare hardware configuration */
@@ -404,7 +546,7 @@ open_alsa:
         return ALC_FALSE;
     }
 
-    if((i=psnd_pcm_hw_params_get_period_size(p, &bufferSizeInFrames, NULL)) < 0)
+    if((i=psnd_pcm_hw_params_get_period_size(p, &periodSizeInFrames, NULL)) < 0)
     {
         AL_PRINT("get_period_size failed: %s\n", psnd_strerror(i));
         psnd_pcm_hw_params_free(p);
@@ -415,7 +557,16 @@ open_alsa:
 
     psnd_pcm_hw_params_free(p);
 
-    device->UpdateSize = bufferSizeInFrames;
+    /* Only wake up once a whole period can be written. Not fatal if it can't
+     * be set, since the mixer waits for a period either way */
+    psnd_pcm_sw_params_malloc(&sp);
+    if((i=psnd_pcm_sw_params_current(data->pcmHandle, sp)) < 0 ||
+       (i=psnd_pcm_sw_params_set_avail_min(data->pcmHandle, sp, periodSizeInFrames)) < 0 ||
+       (i=psnd_pcm_sw_params(data->pcmHandle, sp)) < 0)
+        AL_PRINT("set avail min failed: %s\n", psnd_strerror(i));
+    psnd_pcm_sw_params_free(sp);
+
+    device->UpdateSize = periodSizeInFrames;
 
     data->size = psnd_pcm_frames_to_bytes(data->pcmHandle, device->UpdateSize);
     if(access == SND_PCM_ACCESS_RW_INTERLEAVED)
@@ -477,6 +628,7 @@ static ALCboolean alsa_open_capture(ALCdevice *pDevice, const ALCchar *deviceNam
     snd_pcm_format_t alsaFormat;
     snd_pcm_hw_params_t *p;
     snd_pcm_uframes_t bufferSizeInFrames;
+    snd_pcm_uframes_t periodSizeInFrames;
     alsa_data *data;
     char driver[64];
     char *err;
@@ -542,22 +694,32 @@ open_alsa:
             AL_PRINT("Unknown format?! %x\n", format);
     }
 
+    /* With a period size set, the device only needs a few periods since the
+     * reader thread keeps it drained; otherwise it holds the whole request */
     bufferSizeInFrames = SampleSize;
+    i = GetConfigValueInt("alsa", "capture_period_size", 0);
+    periodSizeInFrames = max(i, 0);
+    if(periodSizeInFrames > 0)
+        bufferSizeInFrames = periodSizeInFrames*4;
 
     psnd_pcm_hw_params_malloc(&p);
 #define ok(func, str) (i=(func),((i<0)?(err=(str)),0:1))
     /* start with the largest configuration space possible */
     if(!(ok(psnd_pcm_hw_params_any(data->pcmHandle, p), "any") &&
          /* set interleaved access */
-         ok(psnd_pcm_hw_params_set_access(data->pcmHandle, p, SND_PCM_ACCESS_MMAP_INTERLEAVED), "set access") &&
+         ok(psnd_pcm_hw_params_set_access(data->pcmHandle, p, SND_PCM_ACCESS_RW_INTERLEAVED), "set access") &&
          /* set format (implicitly sets sample bits) */
          ok(psnd_pcm_hw_params_set_format(data->pcmHandle, p, alsaFormat), "set format") &&
          /* set channels (implicitly sets frame bits) */
          ok(psnd_pcm_hw_params_set_channels(data->pcmHandle, p, aluChannelsFromFormat(pDevice->Format)), "set channels") &&
          /* set rate (implicitly constrains period/buffer parameters) */
          ok(psnd_pcm_hw_params_set_rate(data->pcmHandle, p, frequency, 0), "set rate") &&
+         /* set period size, which is how often the reader thread wakes up */
+         (!periodSizeInFrames || ok(psnd_pcm_hw_params_set_period_size_near(data->pcmHandle, p, &periodSizeInFrames, NULL), "set period size near")) &&
          /* set buffer size in frame units (implicitly sets period size/bytes/time and buffer time/bytes) */
-         ok(psnd_pcm_hw_params_set_buffer_size_min(data->pcmHandle, p, &bufferSizeInFrames), "set buffer size min") &&
+         (periodSizeInFrames ?
+          ok(psnd_pcm_hw_params_set_buffer_size_near(data->pcmHandle, p, &bufferSizeInFrames), "set buffer size near") :
+          ok(psnd_pcm_hw_params_set_buffer_size_min(data->pcmHandle, p, &bufferSizeInFrames), "set buffer size min")) &&
          /* install and prepare hardware configuration */
          ok(psnd_pcm_hw_params(data->pcmHandle, p), "set params")))
     {
@@ -568,26 +730,74 @@ open_alsa:
         return ALC_FALSE;
     }
 #undef ok
+
+    if((i=psnd_pcm_hw_params_get_period_size(p, &periodSizeInFrames, NULL)) < 0)
+    {
+        AL_PRINT("get_period_size failed: %s\n", psnd_strerror(i));
+        psnd_pcm_hw_params_free(p);
+        psnd_pcm_close(data->pcmHandle);
+        free(data);
+        return ALC_FALSE;
+    }
     psnd_pcm_hw_params_free(p);
 
+    // scratch space for a period that has nowhere to go
+    data->size = periodSizeInFrames;
+    data->buffer = malloc(psnd_pcm_frames_to_bytes(data->pcmHandle, data->size));
+    data->ring = CreateRingBuffer(psnd_pcm_frames_to_bytes(data->pcmHandle, 1), SampleSize);
+    data->npfds = psnd_pcm_poll_descriptors_count(data->pcmHandle);
+    if(data->npfds > 0)
+        data->pfds = malloc(data->npfds * sizeof(*data->pfds));
+    if(!data->buffer || !data->ring || !data->pfds ||
+       psnd_pcm_poll_descriptors(data->pcmHandle, data->pfds, data->npfds) < 0)
+    {
+        AL_PRINT("capture setup failed\n");
+        psnd_pcm_close(data->pcmHandle);
+        DestroyRingBuffer(data->ring);
+        free(data->pfds);
+        free(data->buffer);
+        free(data);
+        return ALC_FALSE;
+    }
+
     i = psnd_pcm_prepare(data->pcmHandle);
     if(i < 0)
     {
         AL_PRINT("prepare error: %s\n", psnd_strerror(i));
         psnd_pcm_close(data->pcmHandle);
+        DestroyRingBuffer(data->ring);
+        free(data->pfds);
+        free(data->buffer);
         free(data);
         return ALC_FALSE;
     }
 
     pDevice->ExtraData = data;
+    data->thread = StartThread(ALSACaptureProc, pDevice);
+    if(data->thread == NULL)
+    {
+        psnd_pcm_close(data->pcmHandle);
+        pDevice->ExtraData = NULL;
+        DestroyRingBuffer(data->ring);
+        free(data->pfds);
+        free(data->buffer);
+        free(data);
+        return ALC_FALSE;
+    }
+
     return ALC_TRUE;
 }
 
 static void alsa_close_capture(ALCdevice *pDevice)
 {
     alsa_data *data = (alsa_data*)pDevice->ExtraData;
+    data->killNow = 1;
+    StopThread(data->thread);
     psnd_pcm_close(data->pcmHandle);
 
+    DestroyRingBuffer(data->ring);
+    free(data->pfds);
+    free(data->buffer);
     free(data);
     pDevice->ExtraData = NULL;
 }
@@ -595,97 +805,35 @@ static void alsa_close_capture(ALCdevice *pDevice)
 static void alsa_start_capture(ALCdevice *pDevice)
 {
     alsa_data *data = (alsa_data*)pDevice->ExtraData;
-    psnd_pcm_prepare(data->pcmHandle);
-    psnd_pcm_start(data->pcmHandle);
+    data->doCapture = 1;
 }
 
 static void alsa_stop_capture(ALCdevice *pDevice)
 {
     alsa_data *data = (alsa_data*)pDevice->ExtraData;
-    psnd_pcm_drain(data->pcmHandle);
+    data->doCapture = 0;
 }
 
 static void alsa_capture_samples(ALCdevice *pDevice, ALCvoid *pBuffer, ALCuint lSamples)
 {
     alsa_data *data = (alsa_data*)pDevice->ExtraData;
-    const snd_pcm_channel_area_t *areas = NULL;
-    snd_pcm_sframes_t frames, commitres;
-    snd_pcm_uframes_t size, offset;
-    int err;
-
-    frames = psnd_pcm_avail_update(data->pcmHandle);
-    if(frames < 0)
-    {
-        err = xrun_recovery(data->pcmHandle, frames);
-        if (err < 0)
-            AL_PRINT("available update failed: %s\n", psnd_strerror(err));
-        else
-            frames = psnd_pcm_avail_update(data->pcmHandle);
-    }
-    if (frames < (snd_pcm_sframes_t)lSamples)
-    {
+    if(lSamples <= (ALCuint)RingBufferSize(data->ring))
+        ReadRingBuffer(data->ring, pBuffer, lSamples);
+    else
         SetALCError(ALC_INVALID_VALUE);
-        return;
-    }
-
-    // it is possible that contiguous areas are smaller, thus we use a loop
-    while (lSamples > 0)
-    {
-        char *Pointer;
-        int Count;
-
-        size = lSamples;
-        err = psnd_pcm_mmap_begin(data->pcmHandle, &areas, &offset, &size);
-        if (err < 0)
-        {
-            err = xrun_recovery(data->pcmHandle, err);
-            if (err < 0)
-            {
-                AL_PRINT("mmap begin error: %s\n", psnd_strerror(err));
-                break;
-            }
-            continue;
-        }
-
-        Pointer = (char*)areas->addr + (offset * areas->step / 8);
-        Count = psnd_pcm_frames_to_bytes(data->pcmHandle, size);
-
-        memcpy(pBuffer, Pointer, Count);
-        pBuffer = (char*)pBuffer + Count;
-
-        commitres = psnd_pcm_mmap_commit(data->pcmHandle, offset, size);
-        if (commitres < 0 || (commitres-size) != 0)
-        {
-           AL_PRINT("mmap commit error: %s\n",
-                    psnd_strerror(commitres >= 0 ? -EPIPE : commitres));
-           break;
-        }
-
-        lSamples -= size;
-    }
 }
 
 static ALCuint alsa_available_samples(ALCdevice *pDevice)
 {
     alsa_data *data = (alsa_data*)pDevice->ExtraData;
-    snd_pcm_sframes_t frames = psnd_pcm_avail_update(data->pcmHandle);
-    if(frames < 0)
-    {
-        int err = xrun_recovery(data->pcmHandle, frames);
-        if (err < 0)
-            AL_PRINT("available update failed: %s\n", psnd_strerror(err));
-        else
-            frames = psnd_pcm_avail_update(data->pcmHandle);
-        if(frames < 0) /* ew.. */
-            SetALCError(ALC_INVALID_DEVICE);
-    }
-    return max(frames, 0);
+    return RingBufferSize(data->ring);
 }
 
 
 BackendFuncs alsa_funcs = {
     alsa_open_playback,
     alsa_close_playback,
+    NULL,
     alsa_open_capture,
     alsa_close_capture,
     alsa_start_capture,
@@ -744,9 +892,15 @@ LOAD_FUNC(snd_pcm_hw_params_set_rate_near);
 LOAD_FUNC(snd_pcm_hw_params_set_rate);
 LOAD_FUNC(snd_pcm_hw_params_set_buffer_size_near);
 LOAD_FUNC(snd_pcm_hw_params_set_buffer_size_min);
+LOAD_FUNC(snd_pcm_hw_params_set_period_size_near);
 LOAD_FUNC(snd_pcm_hw_params_get_period_size);
 LOAD_FUNC(snd_pcm_hw_params_get_access);
 LOAD_FUNC(snd_pcm_hw_params);
+LOAD_FUNC(snd_pcm_sw_params_malloc);
+LOAD_FUNC(snd_pcm_sw_params_free);
+LOAD_FUNC(snd_pcm_sw_params_current);
+LOAD_FUNC(snd_pcm_sw_params_set_avail_min);
+LOAD_FUNC(snd_pcm_sw_params);
 LOAD_FUNC(snd_pcm_prepare);
 LOAD_FUNC(snd_pcm_start);
 LOAD_FUNC(snd_pcm_resume);
@@ -757,7 +911,13 @@ LOAD_FUNC(snd_pcm_areas_silence);
 LOAD_FUNC(snd_pcm_mmap_begin);
 LOAD_FUNC(snd_pcm_mmap_commit);
 LOAD_FUNC(snd_pcm_writei);
+LOAD_FUNC(snd_pcm_readi);
+LOAD_FUNC(snd_pcm_delay);
+LOAD_FUNC(snd_pcm_drop);
 LOAD_FUNC(snd_pcm_drain);
+LOAD_FUNC(snd_pcm_poll_descriptors_count);
+LOAD_FUNC(snd_pcm_poll_descriptors);
+LOAD_FUNC(snd_pcm_poll_descriptors_revents);
 
 LOAD_FUNC(snd_pcm_info_malloc);
 LOAD_FUNC(snd_pcm_info_free);
@@ -26,21 +26,12 @@
 #include <math.h>
 
 #include "bs2b.h"
+#include "alu.h"
 
 #ifndef M_PI
 #define M_PI  3.14159265358979323846
 #endif
 
-/* Single pole IIR filter.
- * O[n] = a0*I[n] + a1*I[n-1] + b1*O[n-1]
- */
-
-/* Lowpass filter */
-#define lo_filter(in, out_1) (bs2b->a0_lo*(in) + bs2b->b1_lo*(out_1))
-
-/* Highboost filter */
-#define hi_filter(in, in_1, out_1) (bs2b->a0_hi*(in) + bs2b->a1_hi*(in_1) + bs2b->b1_hi*(out_1))
-
 /* Set up all data. */
 static void init(struct bs2b *bs2b)
 {
@@ -104,15 +95,20 @@ static void init(struct bs2b *bs2b)
      */
 
     x           = exp(-2.0 * M_PI * Fc_lo / bs2b->srate);
-    bs2b->b1_lo = x;
-    bs2b->a0_lo = G_lo * (1.0 - x);
+    bs2b->b1_lo = (float)x;
+    bs2b->a0_lo = (float)(G_lo * (1.0 - x));
+    bs2b->lo2[0] = (float)(x * G_lo * (1.0 - x));
+    bs2b->lo2[1] = (float)(x * x);
 
     x           = exp(-2.0 * M_PI * Fc_hi / bs2b->srate);
-    bs2b->b1_hi = x;
-    bs2b->a0_hi = 1.0 - G_hi * (1.0 - x);
-    bs2b->a1_hi = -x;
+    bs2b->b1_hi = (float)x;
+    bs2b->a0_hi = (float)(1.0 - G_hi * (1.0 - x));
+    bs2b->a1_hi = (float)-x;
+    bs2b->hi2[0] = (float)(-x + x * (1.0 - G_hi * (1.0 - x)));
+    bs2b->hi2[1] = (float)(x * -x);
+    bs2b->hi2[2] = (float)(x * x);
 
-    bs2b->gain  = 1.0 / (1.0 - G_hi + G_lo);
+    bs2b->gain  = (float)(1.0 / (1.0 - G_hi + G_lo));
 
     bs2b_clear(bs2b);
 } /* init */
@@ -171,33 +167,71 @@ int bs2b_is_clear(struct bs2b *bs2b)
 
 void bs2b_cross_feed(struct bs2b *bs2b, float *sample)
 {
-    /* Lowpass filter */
-    bs2b->last_sample.lo[0] = lo_filter(sample[0], bs2b->last_sample.lo[0]);
-    bs2b->last_sample.lo[1] = lo_filter(sample[1], bs2b->last_sample.lo[1]);
-
-    /* Highboost filter */
-    bs2b->last_sample.hi[0] = hi_filter(sample[0], bs2b->last_sample.asis[0], bs2b->last_sample.hi[0]);
-    bs2b->last_sample.hi[1] = hi_filter(sample[1], bs2b->last_sample.asis[1], bs2b->last_sample.hi[1]);
-    bs2b->last_sample.asis[0] = sample[0];
-    bs2b->last_sample.asis[1] = sample[1];
-
-    /* Crossfeed */
-    sample[0] = bs2b->last_sample.hi[0] + bs2b->last_sample.lo[1];
-    sample[1] = bs2b->last_sample.hi[1] + bs2b->last_sample.lo[0];
-
-    /* Bass boost cause allpass attenuation */
-    sample[0] *= bs2b->gain;
-    sample[1] *= bs2b->gain;
-
-    /* Clipping of overloaded samples */
-#if 0
-    if (sample[0] > 1.0)
-        sample[0] = 1.0;
-    if (sample[0] < -1.0)
-        sample[0] = -1.0;
-    if (sample[1] > 1.0)
-        sample[1] = 1.0;
-    if (sample[1] < -1.0)
-        sample[1] = -1.0;
-#endif
+    bs2b_cross_feed_block(bs2b, &sample[0], &sample[1], 2, 1);
 } /* bs2b_cross_feed */
+
+void bs2b_cross_feed_block(struct bs2b *bs2b, float *left, float *right,
+                           int stride, int todo)
+{
+    const float a0_lo = bs2b->a0_lo, b1_lo = bs2b->b1_lo;
+    const float a0_hi = bs2b->a0_hi, a1_hi = bs2b->a1_hi, b1_hi = bs2b->b1_hi;
+    const float lo_x1 = bs2b->lo2[0], lo_y2 = bs2b->lo2[1];
+    const float hi_x1 = bs2b->hi2[0], hi_x2 = bs2b->hi2[1], hi_y2 = bs2b->hi2[2];
+    const float gain = bs2b->gain;
+    float asisL = bs2b->last_sample.asis[0], asisR = bs2b->last_sample.asis[1];
+    float loL = bs2b->last_sample.lo[0], loR = bs2b->last_sample.lo[1];
+    float hiL = bs2b->last_sample.hi[0], hiR = bs2b->last_sample.hi[1];
+    float inL0, inR0, inL1, inR1;
+    float loL0, loR0, hiL0, hiR0;
+    int i = 0;
+
+    /* Two samples per pass. Both outputs are worked out from the history
+     * before the pair, so the second doesn't wait on the first. */
+    for(;i+1 < todo;i += 2)
+    {
+        inL0 = left[i*stride];      inR0 = right[i*stride];
+        inL1 = left[(i+1)*stride];  inR1 = right[(i+1)*stride];
+
+        /* Lowpass filter */
+        loL0 = a0_lo*inL0 + b1_lo*loL;
+        loR0 = a0_lo*inR0 + b1_lo*loR;
+        loL  = a0_lo*inL1 + lo_x1*inL0 + lo_y2*loL;
+        loR  = a0_lo*inR1 + lo_x1*inR0 + lo_y2*loR;
+
+        /* Highboost filter */
+        hiL0 = a0_hi*inL0 + a1_hi*asisL + b1_hi*hiL;
+        hiR0 = a0_hi*inR0 + a1_hi*asisR + b1_hi*hiR;
+        hiL  = a0_hi*inL1 + hi_x1*inL0 + hi_x2*asisL + hi_y2*hiL;
+        hiR  = a0_hi*inR1 + hi_x1*inR0 + hi_x2*asisR + hi_y2*hiR;
+        asisL = inL1;
+        asisR = inR1;
+
+        /* Crossfeed, with the gain against the bass boost */
+        left[i*stride]      = (hiL0 + loR0) * gain;
+        right[i*stride]     = (hiR0 + loL0) * gain;
+        left[(i+1)*stride]  = (hiL + loR) * gain;
+        right[(i+1)*stride] = (hiR + loL) * gain;
+    }
+    for(;i < todo;i++)
+    {
+        inL0 = left[i*stride];
+        inR0 = right[i*stride];
+
+        loL = a0_lo*inL0 + b1_lo*loL;
+        loR = a0_lo*inR0 + b1_lo*loR;
+        hiL = a0_hi*inL0 + a1_hi*asisL + b1_hi*hiL;
+        hiR = a0_hi*inR0 + a1_hi*asisR + b1_hi*hiR;
+        asisL = inL0;
+        asisR = inR0;
+
+        left[i*stride]  = (hiL + loR) * gain;
+        right[i*stride] = (hiR + loL) * gain;
+    }
+
+    bs2b->last_sample.asis[0] = asisL;
+    bs2b->last_sample.asis[1] = asisR;
+    bs2b->last_sample.lo[0] = aluFlushDenormal(loL);
+    bs2b->last_sample.lo[1] = aluFlushDenormal(loR);
+    bs2b->last_sample.hi[0] = aluFlushDenormal(hiL);
+    bs2b->last_sample.hi[1] = aluFlushDenormal(hiR);
+} /* bs2b_cross_feed_block */
@@ -106,11 +106,10 @@ static ALuint DSoundProc(ALvoid *ptr)
         // Successfully locked the output buffer
         if(SUCCEEDED(err))
         {
-            // If we have an active context, mix data directly into output buffer otherwise fill with silence
-            SuspendContext(NULL);
-            aluMixData(pDevice->Context, WritePtr1, WriteCnt1, pDevice->Format);
-            aluMixData(pDevice->Context, WritePtr2, WriteCnt2, pDevice->Format);
-            ProcessContext(NULL);
+            // Fill the output buffer with the next mix, which is silence without an active context
+            RenderDeviceData(pDevice, WritePtr1, WriteCnt1);
+            if(WriteCnt2 > 0)
+                RenderDeviceData(pDevice, WritePtr2, WriteCnt2);
 
             // Unlock output buffer only when successfully locked
             IDirectSoundBuffer_Unlock(pData->DSsbuffer, WritePtr1, WriteCnt1, WritePtr2, WriteCnt2);
@@ -176,6 +175,20 @@ static ALCboolean DSoundOpenPlayback(ALCdevice *device, const ALCchar *deviceNam
     if(SUCCEEDED(hr))
     {
         speakers = DSSPEAKER_CONFIG(speakers);
+        if(aluBytesFromFormat(device->Format) == 4)
+        {
+            /* The buffer is set up as integer PCM, so mix to 16-bit instead
+             * of float, whatever the speaker config */
+            switch(aluChannelsFromFormat(device->Format))
+            {
+                case 1: device->Format = AL_FORMAT_MONO16; break;
+                case 2: device->Format = AL_FORMAT_STEREO16; break;
+                case 4: device->Format = AL_FORMAT_QUAD16; break;
+                case 6: device->Format = AL_FORMAT_51CHN16; break;
+                case 7: device->Format = AL_FORMAT_61CHN16; break;
+                case 8: device->Format = AL_FORMAT_71CHN16; break;
+            }
+        }
         if(speakers == DSSPEAKER_MONO)
         {
             if(aluBytesFromFormat(device->Format) == 1)
@@ -359,6 +372,7 @@ static ALCuint DSoundAvailableSamples(ALCdevice *pDevice)
 BackendFuncs DSoundFuncs = {
     DSoundOpenPlayback,
     DSoundClosePlayback,
+    NULL,
     DSoundOpenCapture,
     DSoundCloseCapture,
     DSoundStartCapture,
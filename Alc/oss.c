@@ -87,11 +87,7 @@ static ALuint OSSProc(ALvoid *ptr)
         int len = data->data_size - remaining;
 
         if(len > 0)
-        {
-            SuspendContext(NULL);
-            aluMixData(pDevice->Context, data->mix_data+remaining, len, pDevice->Format);
-            ProcessContext(NULL);
-        }
+            RenderDeviceData(pDevice, data->mix_data+remaining, len);
 
         remaining += len;
         wrote = write(data->fd, data->mix_data, remaining);
@@ -125,7 +121,20 @@ static ALuint OSSCaptureProc(ALvoid *ptr)
 
     while(!data->killNow)
     {
-        amt = read(data->fd, data->mix_data, data->data_size);
+        RingBufferRegion regions[2];
+        ALubyte *dst = data->mix_data;
+        int len = data->data_size;
+
+        /* Read straight into the ring when capturing and there's room, else
+         * into the scratch buffer to be dropped */
+        PeekWriteRingBuffer(data->ring, regions);
+        if(data->doCapture && regions[0].len > 0)
+        {
+            dst = regions[0].ptr;
+            len = min(len, regions[0].len*frameSize);
+        }
+
+        amt = read(data->fd, dst, len);
         if(amt < 0)
         {
             AL_PRINT("read failed: %s\n", strerror(errno));
@@ -136,8 +145,10 @@ static ALuint OSSCaptureProc(ALvoid *ptr)
             Sleep(1);
             continue;
         }
-        if(data->doCapture)
-            WriteRingBuffer(data->ring, data->mix_data, amt/frameSize);
+        if(dst != data->mix_data)
+            CommitWriteRingBuffer(data->ring, amt/frameSize);
+        else if(data->doCapture)
+            pDevice->CaptureOverruns++;
     }
 
     return 0;
@@ -180,6 +191,20 @@ static ALCboolean oss_open_playback(ALCdevice *device, const ALCchar *deviceName
         return ALC_FALSE;
     }
 
+    if(aluBytesFromFormat(device->Format) == 4)
+    {
+        /* OSS has no portable float format, so mix to 16-bit instead */
+        switch(aluChannelsFromFormat(device->Format))
+        {
+            case 1: device->Format = AL_FORMAT_MONO16; break;
+            case 2: device->Format = AL_FORMAT_STEREO16; break;
+            case 4: device->Format = AL_FORMAT_QUAD16; break;
+            case 6: device->Format = AL_FORMAT_51CHN16; break;
+            case 7: device->Format = AL_FORMAT_61CHN16; break;
+            case 8: device->Format = AL_FORMAT_71CHN16; break;
+        }
+    }
+
     switch(aluBytesFromFormat(device->Format))
     {
         case 1:
@@ -435,6 +460,7 @@ static ALCuint oss_available_samples(ALCdevice *pDevice)
 BackendFuncs oss_funcs = {
     oss_open_playback,
     oss_close_playback,
+    NULL,
     oss_open_capture,
     oss_close_capture,
     oss_start_capture,
@@ -87,6 +87,14 @@
 #error Invalid PulseAudio API version
 #endif
 
+/* pa_stream_begin_write() lets us mix straight into the server's memory
+ * block; older libraries only have pa_stream_write(), which copies */
+#ifdef PA_CHECK_VERSION
+#if PA_CHECK_VERSION(0,9,16)
+#define HAVE_PA_STREAM_BEGIN_WRITE
+#endif
+#endif
+
 #if (G_BYTE_ORDER == G_LITTLE_ENDIAN)
 # define ENDIANNESS   "LITTLE_ENDIAN, BIG_ENDIAN"
 #else
@@ -94,20 +102,39 @@
 #endif
 
 static char *pulseaudio_playback_device;
-static pa_context *context = NULL;
-static pa_stream *stream = NULL;
-
-static pa_threaded_mainloop* mainloop = NULL;
-
-static char *stream_name = NULL, *client_name = NULL, *pa_device = NULL;
+static char *pulseaudio_capture_device;
+
+/* everything a device needs to talk to the server. each device gets its own
+ * threaded mainloop, context and stream, kept in the device's ExtraData, so
+ * any number of devices can be open and mixing at once */
+typedef struct {
+    ALCdevice *device;
+
+    pa_threaded_mainloop *mainloop;
+    pa_context *context;
+    pa_stream *stream;
+
+    pa_sample_spec sample_spec;
+    pa_channel_map channel_map;
+    size_t frame_size;
+
+#ifndef HAVE_PA_STREAM_BEGIN_WRITE
+    /* preallocated mix buffer, handed to pa_stream_write() in pieces */
+    void *mix_buffer;
+    size_t mix_buffer_size;
+#endif
 
-static pa_sample_spec sample_spec = { 0, 0, 0 };
-static pa_channel_map channel_map;
-static int channel_map_set = 0;
+    /* captured frames, filled by the read callback on the mainloop thread
+     * and drained by alcCaptureSamples on the app's */
+    RingBuffer *ring;
 
-char *server = NULL;
+    char *client_name;
+    char *stream_name;
 
-ALCdevice *device_=NULL;
+    /* set once the mainloop thread has taken the rt-prio/cpu-affinity
+     * settings; that thread is libpulse's, so it's done from a callback */
+    ALboolean thread_setup;
+} pulse_data;
 
 enum {
     ARG_VERSION = 256,
@@ -137,18 +164,12 @@ enum {
 **
 ** TODO how to write a openAL soft backend tutorial
 **
-** TODO remove global variables, so that multiple instances of this openAL library
-**      can coexist
-**
 ** TODO linked or dlopen'ed lib
 **      04:35 <+KittyCat> alsa can either be linked as a required lib, or is opened with dlopen
 **      04:35 <+KittyCat> it still uses the shared lib, but it'd be required for openal to load
 **
 ** TODO pulseaudio library detection in CMakeLists.txt isn't good
 **
-** TODO 05:16 <+KittyCat> UpdateSize is also the total output buffer size to set
-**      05:17 <+KittyCat> generally you should also set it to the period size (how many frames it'll mix for
-**            each update)
 
 ** FIXME timing is not synced with the openAL using program
 **
@@ -173,8 +194,6 @@ enum {
 ** TODO multichannel setup, keep streams in synced
 **
 ** TODO keep stream in sync in general, skip some audio in case of a freez
-**
-** TODO check the prebuffer and attr values for being ok
 
 //   const char *fname;
 //   fname = GetConfigValue("pulseaudio", "capture_channels", "2");
@@ -219,40 +238,77 @@ enum {
 static void stream_write_callback(pa_stream *s, size_t length, void *userdata) {
 //WARNING using printf from this function might cause even more underflows
 //     printf("stream_write_callback: requesting max.: %i\n", length);
-    (void)userdata;
+    pulse_data *data = (pulse_data*)userdata;
+    ALCdevice *device = data->device;
+    size_t frameSize = data->frame_size;
     assert(s && length);
 
-//     size_t k = pa_frame_size(&sample_spec);
-    pa_threaded_mainloop_signal(mainloop, 0);
-//     printf("stream_write_callback: pa_frame_size: %i  && bytes: %i\n",k,bytes);
+    if (!data->thread_setup) {
+        SetMixerThreadAttributes();
+        data->thread_setup = AL_TRUE;
+    }
 
-    char *WritePtr;
-    int WriteCnt;
-    void *data;
+    pa_threaded_mainloop_signal(data->mainloop, 0);
 
-    data = pa_xmalloc(length);
-    memset(data,0,length);
+    // render in place, without allocating or clearing anything; the server
+    // may hand out less than was requested at once, so loop until it's all
+    // done
+    while (length >= frameSize) {
+        void *WritePtr;
+        size_t WriteCnt = length;
 
-    // size s = how much data can be taken from openAL
+#ifdef HAVE_PA_STREAM_BEGIN_WRITE
+        if (pa_stream_begin_write(s, &WritePtr, &WriteCnt) < 0 || !WritePtr) {
+            AL_PRINT("pa_stream_begin_write() failed: %s\n", pa_strerror(pa_context_errno(data->context)));
+            break;
+        }
+#else
+        WritePtr = data->mix_buffer;
+        WriteCnt = min(WriteCnt, data->mix_buffer_size);
+#endif
+        WriteCnt -= WriteCnt % frameSize;
+        if (WriteCnt == 0) {
+#ifdef HAVE_PA_STREAM_BEGIN_WRITE
+            pa_stream_cancel_write(s);
+#endif
+            break;
+        }
 
-    SuspendContext(NULL);
-    WritePtr = data;
-    WriteCnt = length;
-    aluMixData(device_->Context, WritePtr, WriteCnt, device_->Format);
-    ProcessContext(NULL);
+        RenderDeviceData(device, WritePtr, WriteCnt);
 
-    // Return the size of a frame with the specific sample type
-    pa_stream_write(s, data, length, /*pa_xfree*/NULL, 0, PA_SEEK_RELATIVE);
+        // with begin_write, this hands the block over without copying;
+        // otherwise the data is copied and our buffer can be reused
+        pa_stream_write(s, WritePtr, WriteCnt, NULL, 0, PA_SEEK_RELATIVE);
+        length -= WriteCnt;
+    }
+}
 
-    // FIXME should px_xfree be NULL or pa_xfree? what is the difference?
-    pa_xfree(data);
+/* This is called whenever new data may be read from the stream */
+static void stream_read_callback(pa_stream *s, size_t length, void *userdata) {
+    pulse_data *data = (pulse_data*)userdata;
+    const void *buf;
+    size_t len;
+    (void)length;
+
+    if (!data->thread_setup) {
+        SetMixerThreadAttributes();
+        data->thread_setup = AL_TRUE;
+    }
+
+    while (pa_stream_peek(s, &buf, &len) == 0 && len > 0) {
+        // a NULL buffer is a hole in the stream; nothing to keep, but it
+        // still has to be dropped
+        if (buf && WriteRingBuffer(data->ring, buf, len / data->frame_size) < (ALsizei)(len / data->frame_size))
+            data->device->CaptureOverruns++;
+        pa_stream_drop(s);
+    }
 }
 
 static void stream_latency_update_callback(pa_stream *s, void *userdata) {
 // AL_PRINT("stream_latency_update_callback\n");
-    (void)userdata;
+    pulse_data *data = (pulse_data*)userdata;
     assert(s);
-    pa_threaded_mainloop_signal(mainloop, 0);
+    pa_threaded_mainloop_signal(data->mainloop, 0);
 }
 
 void stream_overflow_callback(pa_stream *p, void *userdata) {
@@ -268,7 +324,7 @@ void stream_underflow_callback(pa_stream *p, void *userdata) {
 static void stream_state_callback(pa_stream *s, void *userdata) {
 //     GstPulseSink *pulsesink = GST_PULSESINK(userdata);
     AL_PRINT("stream_state_callback\n");
-    (void)userdata;
+    pulse_data *data = (pulse_data*)userdata;
     assert(s);
     char* f;
     f="";
@@ -282,7 +338,7 @@ static void stream_state_callback(pa_stream *s, void *userdata) {
 
     case PA_STREAM_TERMINATED:
         if (f=="") f="PA_STREAM_TERMINATED";
-        pa_threaded_mainloop_signal(/*pulsesink->*/mainloop, 0);
+        pa_threaded_mainloop_signal(data->mainloop, 0);
         break;
 
     case PA_STREAM_UNCONNECTED:
@@ -297,7 +353,7 @@ static void stream_state_callback(pa_stream *s, void *userdata) {
 static void context_state_callback(pa_context *c, void *userdata) {
 //     GstPulseSink *pulsesink = GST_PULSESINK(userdata);
     AL_PRINT("context_state_callback\n");
-    (void)userdata;
+    pulse_data *data = (pulse_data*)userdata;
     char* f;
     f="";
     assert(c);
@@ -308,7 +364,7 @@ static void context_state_callback(pa_context *c, void *userdata) {
         if (f=="") f="PA_CONTEXT_TERMINATED";
     case PA_CONTEXT_FAILED:
         if (f=="") f="PA_CONTEXT_FAILED";
-        pa_threaded_mainloop_signal(mainloop, 0);
+        pa_threaded_mainloop_signal(data->mainloop, 0);
         break;
 
     case PA_CONTEXT_UNCONNECTED:
@@ -348,125 +404,162 @@ static void context_state_callback(pa_context *c, void *userdata) {
 
 // }
 
-static ALCboolean PulseAudioOpenPlayback(ALCdevice *device, const ALCchar *deviceName) {
-    AL_PRINT("alcPulseAudio PulseAudioOpenPlayback\n");
-//     16:28 < mathrick> what's glitch free?
-//     16:29 < mezcalero> qknight: pa_get_binary_name()
-//     16:29 < mezcalero> qknight: it's actually exported
-//     16:29 < mezcalero> qknight: so you can use it in your clients
-//     16:29 < mezcalero> uses /proc/self/exe and PR_GET_NAME on linux
-//     16:29 < mezcalero> GetModuleFileName() on windows
-
-    //FIXME this code is linuxonly and needs to be handled like that
-    FILE* input = fopen("/proc/self/cmdline","r");
-
-    if (input != NULL) {
-        int ch = getc( input );
-        while ( ch != EOF ) {
-            if (ch == ' ')
-                break;
-            printf( "%c", ch );
-            ch = getc( input );
-        }
-        printf("\n");
-    }
+/* Creates the mainloop and a context connected to the server. On success the
+ * mainloop is running and locked */
+static ALCboolean pulse_connect(pulse_data *data, const char *stream_name) {
+    const char *n = "openAL-soft client";
 
-    device_=device;
-    (void)deviceName;
+    data->client_name = pa_locale_to_utf8(n);
+    if (!data->client_name)
+        data->client_name = pa_utf8_filter(n);
 
-    setlocale(LC_ALL, "");
+    data->stream_name = pa_locale_to_utf8(stream_name);
+    if (!data->stream_name)
+        data->stream_name = pa_utf8_filter(stream_name);
 
-    switch (aluBytesFromFormat(device->Format)) {
-    case 1:
-        sample_spec.format = PA_SAMPLE_U8;
-        printf("fromat: AFMT_U8\n");
-        break;
-    case 2:
-        sample_spec.format = PA_SAMPLE_S16LE;
-        printf("fromat: AFMT_S16_NE\n");
-        break;
-    default:
-        AL_PRINT("fromat: Unknown format?! %x\n", device->Format);
-        goto error_and_forced_exit;
+    /* Set up a new main loop */
+    if (!(data->mainloop = pa_threaded_mainloop_new())) {
+        fprintf(stderr, "pa_threaded_mainloop_new() failed.\n");
+        return ALC_FALSE;
     }
 
-    sample_spec.rate = device->Frequency;
-    sample_spec.channels = aluChannelsFromFormat(device->Format);
+    /* Create a new connection context */
+    if (!(data->context = pa_context_new(pa_threaded_mainloop_get_api(data->mainloop), data->client_name))) {
+      fprintf(stderr, "pa_context_new() failed.\n");
+      return ALC_FALSE;
+    }
 
-    assert(pa_sample_spec_valid(&sample_spec));
+    pa_context_set_state_callback(data->context, context_state_callback, data);
 
-    char t[PA_SAMPLE_SPEC_SNPRINT_MAX];
-    pa_sample_spec_snprint(t, sizeof(t), &sample_spec);
-    fprintf(stderr, "Using sample spec '%s'\n", t);
+    /* Connect the context */
+    if (pa_context_connect(data->context, NULL, 0, NULL) < 0) {
+      printf("AO: [pulse] Failed to connect to server: %s\n", pa_strerror(pa_context_errno(data->context)));
+      return ALC_FALSE;
+    }
 
-    pa_channel_map_init_auto(&channel_map, sample_spec.channels, PA_CHANNEL_MAP_ALSA);
+    pa_threaded_mainloop_lock(data->mainloop);
 
-    if (channel_map_set && channel_map.channels != sample_spec.channels) {
-        fprintf(stderr, "Channel map doesn't match file.\n");
-        goto error_and_forced_exit;
+    if (pa_threaded_mainloop_start(data->mainloop) < 0) {
+      printf("AO: [pulse] Failed to start main loop\n");
+      pa_threaded_mainloop_unlock(data->mainloop);
+      return ALC_FALSE;
     }
 
-    const char *n = "openAL-soft client";
+    /* Wait until the context is ready */
+    pa_threaded_mainloop_wait(data->mainloop);
 
-    if (!client_name) {
-        client_name = pa_locale_to_utf8(n);
-        if (!client_name)
-            client_name = pa_utf8_filter(n);
+    if (pa_context_get_state(data->context) != PA_CONTEXT_READY) {
+      printf("AO: [pulse] Failed to connect to server: %s\n", pa_strerror(pa_context_errno(data->context)));
+      pa_threaded_mainloop_unlock(data->mainloop);
+      return ALC_FALSE;
     }
 
-    const char *n1 = "openAL out";
+    return ALC_TRUE;
+}
+
+/* Tears down whatever part of the connection was made. The mainloop must not
+ * be locked */
+static void pulse_destroy(pulse_data *data) {
+    if (data->mainloop) {
+        pa_threaded_mainloop_lock(data->mainloop);
 
-    stream_name = pa_locale_to_utf8(n1);
-    if (!stream_name)
-        stream_name = pa_utf8_filter(n1);
+        if (data->stream) {
+            pa_stream_disconnect(data->stream);
+            pa_stream_unref(data->stream);
+        }
 
-    /* Set up a new main loop */
-    if (!(mainloop = pa_threaded_mainloop_new())) {
-        fprintf(stderr, "pa_threaded_mainloop_new() failed.\n");
-        goto error_and_forced_exit;
-    }
+        if (data->context) {
+            pa_context_disconnect(data->context);
+            pa_context_unref(data->context);
+        }
 
-    // this scope will be outsourced in a function
-//     getPulseContext();
-    /* Create a new connection context */
-    if (!(context = pa_context_new(pa_threaded_mainloop_get_api(mainloop), client_name))) {
-      fprintf(stderr, "pa_context_new() failed.\n");
-      goto error_and_forced_exit;
+        pa_threaded_mainloop_unlock(data->mainloop);
+        pa_threaded_mainloop_stop(data->mainloop);
+        pa_threaded_mainloop_free(data->mainloop);
     }
 
-    pa_context_set_state_callback(context, context_state_callback, NULL);
+    pa_xfree(data->client_name);
+    pa_xfree(data->stream_name);
+#ifndef HAVE_PA_STREAM_BEGIN_WRITE
+    free(data->mix_buffer);
+#endif
+    DestroyRingBuffer(data->ring);
+    free(data);
+}
 
-    /* Connect the context */
-    if (pa_context_connect(context, server, 0, NULL) < 0) {
-      printf("AO: [pulse] Failed to connect to server: %s\n", pa_strerror(pa_context_errno(context)));
-      goto error_and_forced_exit;
+/* Fills in the sample spec and channel map for an AL format */
+static ALCboolean pulse_set_spec(pulse_data *data, ALenum format, ALuint frequency) {
+    switch (aluBytesFromFormat(format)) {
+    case 1:
+        data->sample_spec.format = PA_SAMPLE_U8;
+        break;
+    case 2:
+        data->sample_spec.format = PA_SAMPLE_S16NE;
+        break;
+    case 4:
+        data->sample_spec.format = PA_SAMPLE_FLOAT32NE;
+        break;
+    default:
+        AL_PRINT("fromat: Unknown format?! %x\n", format);
+        return ALC_FALSE;
     }
 
-    pa_threaded_mainloop_lock(mainloop);
+    data->sample_spec.rate = frequency;
+    data->sample_spec.channels = aluChannelsFromFormat(format);
 
-    if (pa_threaded_mainloop_start(mainloop) < 0) {
-      printf("AO: [pulse] Failed to start main loop\n");
-      goto error_and_forced_exit;
+    if (!pa_sample_spec_valid(&data->sample_spec)) {
+        AL_PRINT("Invalid sample spec\n");
+        return ALC_FALSE;
     }
+    data->frame_size = pa_frame_size(&data->sample_spec);
 
-    /* Wait until the context is ready */
-    pa_threaded_mainloop_wait(mainloop);
+    char t[PA_SAMPLE_SPEC_SNPRINT_MAX];
+    pa_sample_spec_snprint(t, sizeof(t), &data->sample_spec);
+    fprintf(stderr, "Using sample spec '%s'\n", t);
 
-    if (pa_context_get_state(context) != PA_CONTEXT_READY) {
-      printf("AO: [pulse] Failed to connect to server: %s\n", pa_strerror(pa_context_errno(context)));
-      goto error_and_forced_exit;
+    pa_channel_map_init_auto(&data->channel_map, data->sample_spec.channels, PA_CHANNEL_MAP_ALSA);
+    return ALC_TRUE;
+}
+
+static ALCboolean PulseAudioOpenPlayback(ALCdevice *device, const ALCchar *deviceName) {
+    AL_PRINT("alcPulseAudio PulseAudioOpenPlayback\n");
+    pulse_data *data;
+
+    if (deviceName && strcmp(deviceName, pulseaudio_playback_device) != 0)
+        return ALC_FALSE;
+    device->szDeviceName = pulseaudio_playback_device;
+
+    setlocale(LC_ALL, "");
+
+    data = (pulse_data*)calloc(1, sizeof(pulse_data));
+    if (!data)
+        return ALC_FALSE;
+    data->device = device;
+
+    if (!pulse_set_spec(data, device->Format, device->Frequency))
+        goto error_and_forced_exit;
+
+#ifndef HAVE_PA_STREAM_BEGIN_WRITE
+    data->mix_buffer_size = device->UpdateSize * data->frame_size;
+    if (!(data->mix_buffer = malloc(data->mix_buffer_size))) {
+        AL_PRINT("mix buffer malloc failed\n");
+        goto error_and_forced_exit;
     }
+#endif
+
+    if (!pulse_connect(data, "openAL out"))
+        goto error_and_forced_exit;
 
-    if (!(stream = pa_stream_new(context, stream_name, &sample_spec, &channel_map))) {
-      printf("AO: [pulse] Failed to create stream: %s\n", pa_strerror(pa_context_errno(context)));
-      goto error_and_forced_exit;
+    if (!(data->stream = pa_stream_new(data->context, data->stream_name, &data->sample_spec, &data->channel_map))) {
+      printf("AO: [pulse] Failed to create stream: %s\n", pa_strerror(pa_context_errno(data->context)));
+      goto error_unlock;
     }
 
-    pa_stream_set_state_callback(stream, stream_state_callback, NULL);
-    pa_stream_set_latency_update_callback(stream, stream_latency_update_callback, NULL);
-    pa_stream_set_write_callback(stream, stream_write_callback, NULL);
-    pa_stream_set_overflow_callback(stream,stream_overflow_callback, NULL);
-    pa_stream_set_underflow_callback(stream,stream_underflow_callback, NULL);
+    pa_stream_set_state_callback(data->stream, stream_state_callback, data);
+    pa_stream_set_latency_update_callback(data->stream, stream_latency_update_callback, data);
+    pa_stream_set_write_callback(data->stream, stream_write_callback, data);
+    pa_stream_set_overflow_callback(data->stream, stream_overflow_callback, data);
+    pa_stream_set_underflow_callback(data->stream, stream_underflow_callback, data);
 
     /*
     some usefull comments about pa_buffer_attr can be found here:
@@ -474,122 +567,202 @@ static ALCboolean PulseAudioOpenPlayback(ALCdevice *device, const ALCchar *devic
     - http://www.mail-archive.com/pulseaudio-discuss%40mail.0pointer.de/msg01012.html
     */
 
+    // the total buffer is either the configured latency (in milliseconds) or
+    // UpdateSize frames, split into 'periods' requests. with ADJUST_LATENCY
+    // the server sizes its own buffers so tlength is the overall latency
+    size_t frameSize = data->frame_size;
+    int latency = GetConfigValueInt("pulseaudio", "latency", 0);
+    int periods = GetConfigValueInt("pulseaudio", "periods", 4);
+    if (periods <= 0)
+        periods = 4;
+
     pa_buffer_attr attr;
-    memset(&attr, 0, sizeof(attr));
-
-    // not used right now, can be enabled in pa_stream_connect_playback() if the third argument
-    // is &attr instead of NULL
-    // this code is obsolete once the glitch_free pulseaudio branche is working
-    attr.tlength=8000;
-    attr.maxlength=16000;//attr.tlength*2;
-    attr.prebuf=8000;
-    attr.minreq=0;
-    attr.fragsize=0;
-
-    printf("%i maxlength\n", attr.maxlength);
-    printf("%i tlength\n", attr.tlength);
-    printf("%i prebuf\n", attr.prebuf);
-    printf("%i minreq\n", attr.minreq);
-    printf("%i fragsize\n", attr.fragsize);
+    if (latency > 0)
+        attr.tlength = pa_usec_to_bytes((pa_usec_t)latency * 1000, &data->sample_spec);
+    else
+        attr.tlength = device->UpdateSize * frameSize;
+    attr.minreq = attr.tlength / periods;
+    attr.minreq -= attr.minreq % frameSize;
+    if (attr.minreq < frameSize)
+        attr.minreq = frameSize;
+    attr.tlength = attr.minreq * periods;
+    attr.maxlength = (uint32_t)-1;
+    attr.prebuf = (uint32_t)-1;
+    attr.fragsize = (uint32_t)-1;
+
+    // the write callback can fire as soon as the stream connects
+    device->ExtraData = data;
 
     // latency happens from this call
-    if (pa_stream_connect_playback(stream, NULL, /*NULL*/&attr, PA_STREAM_INTERPOLATE_TIMING|PA_STREAM_AUTO_TIMING_UPDATE, NULL, NULL) < 0) {
-      printf("AO: [pulse] Failed to connect stream: %s\n", pa_strerror(pa_context_errno(context)));
-      goto error_and_forced_exit;
+    if (pa_stream_connect_playback(data->stream, NULL, &attr, PA_STREAM_INTERPOLATE_TIMING|PA_STREAM_AUTO_TIMING_UPDATE|PA_STREAM_ADJUST_LATENCY, NULL, NULL) < 0) {
+      printf("AO: [pulse] Failed to connect stream: %s\n", pa_strerror(pa_context_errno(data->context)));
+      goto error_unlock;
     }
     /* Wait until the stream is ready */
-    pa_threaded_mainloop_wait(mainloop);
+    pa_threaded_mainloop_wait(data->mainloop);
+
+    if (pa_stream_get_state(data->stream) != PA_STREAM_READY) {
+      printf("AO: [pulse] Failed to connect to server: %s\n", pa_strerror(pa_context_errno(data->context)));
+      goto error_unlock;
+    }
 
-    if (pa_stream_get_state(stream) != PA_STREAM_READY) {
-      printf("AO: [pulse] Failed to connect to server: %s\n", pa_strerror(pa_context_errno(context)));
-      goto error_and_forced_exit;
+    // the server may not give us what we asked for; report what we got, with
+    // one request being one update like the other backends
+    const pa_buffer_attr *got = pa_stream_get_buffer_attr(data->stream);
+    if (got && got->minreq >= frameSize) {
+        device->UpdateSize = got->minreq / frameSize;
+        AL_PRINT("pulse buffer: tlength %u, minreq %u (%u frames per update)\n",
+                 got->tlength, got->minreq, device->UpdateSize);
     }
 
-    pa_threaded_mainloop_unlock(mainloop);
+    pa_threaded_mainloop_unlock(data->mainloop);
 
     return ALC_TRUE;
 
+error_unlock:
+    pa_threaded_mainloop_unlock(data->mainloop);
 error_and_forced_exit:
-
-    printf("error_and_forced_exit\n");
-
-    //FIXME, free stuff which might be in use already
-    printf("FIXME, free stuff which might be in use already\n");
-
+    device->ExtraData = NULL;
+    pulse_destroy(data);
     return ALC_FALSE;
 }
 
 static void PulseAudioClosePlayback(ALCdevice *device) {
-    (void)device;
+    pulse_data *data = (pulse_data*)device->ExtraData;
 
     AL_PRINT("alcPulseAudio PulseAudioClosePlayback\n");
 
-    pa_threaded_mainloop_lock(mainloop);
+    pulse_destroy(data);
+    device->ExtraData = NULL;
+}
 
-    if (stream)
-        pa_stream_unref(stream);
+static ALCboolean PulseAudioOpenCapture(ALCdevice *pDevice, const ALCchar *deviceName, ALCuint frequency, ALCenum format, ALCsizei SampleSize) {
+    AL_PRINT("alcPulseAudio PulseAudioOpenCapture\n");
+    pulse_data *data;
+
+    if (deviceName && strcmp(deviceName, pulseaudio_capture_device) != 0)
+        return ALC_FALSE;
+    pDevice->szDeviceName = pulseaudio_capture_device;
+
+    setlocale(LC_ALL, "");
+
+    data = (pulse_data*)calloc(1, sizeof(pulse_data));
+    if (!data)
+        return ALC_FALSE;
+    data->device = pDevice;
 
-    if (context)
-        pa_context_unref(context);
+    if (!pulse_set_spec(data, format, frequency))
+        goto error_and_forced_exit;
 
-    if (mainloop) {
-        pa_threaded_mainloop_unlock(mainloop);
-        pa_threaded_mainloop_stop(mainloop);
+    data->ring = CreateRingBuffer(data->frame_size, SampleSize);
+    if (!data->ring) {
+        AL_PRINT("ring buffer create failed\n");
+        goto error_and_forced_exit;
     }
 
-    pa_xfree(server);
-    pa_xfree(pa_device);
-    pa_xfree(client_name);
-    pa_xfree(stream_name);
-//     pa_mainloop_free(mainloop);
+    if (!pulse_connect(data, "openAL in"))
+        goto error_and_forced_exit;
 
-    printf("alcPulseAudio PulseAudioClosePlayback done\n");
-//   pa_threaded_mainloop_unlock(mainloop);
-}
+    if (!(data->stream = pa_stream_new(data->context, data->stream_name, &data->sample_spec, &data->channel_map))) {
+      printf("AO: [pulse] Failed to create stream: %s\n", pa_strerror(pa_context_errno(data->context)));
+      goto error_unlock;
+    }
 
-static ALCboolean PulseAudioOpenCapture(ALCdevice *pDevice, const ALCchar *deviceName, ALCuint frequency, ALCenum format, ALCsizei SampleSize) {
-    AL_PRINT("alcPulseAudio PulseAudioOpenCapture\n");
-    AL_PRINT("FIXME: NOT DONE YET\n");
-    (void)pDevice;
-    (void)deviceName;
-    (void)frequency;
-    (void)format;
-    (void)SampleSize;
+    pa_stream_set_state_callback(data->stream, stream_state_callback, data);
+    pa_stream_set_read_callback(data->stream, stream_read_callback, data);
+    pa_stream_set_overflow_callback(data->stream, stream_overflow_callback, data);
+
+    // the fragment size is how much the server collects before handing it
+    // over, which is the capture latency. it's configurable in milliseconds,
+    // and otherwise a quarter of the app's buffer so it can't overrun
+    // between fragments
+    int fragsize = GetConfigValueInt("pulseaudio", "fragsize", 0);
+
+    pa_buffer_attr attr;
+    if (fragsize > 0)
+        attr.fragsize = pa_usec_to_bytes((pa_usec_t)fragsize * 1000, &data->sample_spec);
+    else
+        attr.fragsize = SampleSize / 4 * data->frame_size;
+    if (attr.fragsize < data->frame_size)
+        attr.fragsize = data->frame_size;
+    attr.maxlength = (uint32_t)-1;
+    attr.tlength = (uint32_t)-1;
+    attr.prebuf = (uint32_t)-1;
+    attr.minreq = (uint32_t)-1;
+
+    pDevice->ExtraData = data;
+
+    // capture starts corked, and is uncorked by alcCaptureStart
+    if (pa_stream_connect_record(data->stream, NULL, &attr, PA_STREAM_START_CORKED|PA_STREAM_ADJUST_LATENCY) < 0) {
+      printf("AO: [pulse] Failed to connect stream: %s\n", pa_strerror(pa_context_errno(data->context)));
+      goto error_unlock;
+    }
+    /* Wait until the stream is ready */
+    pa_threaded_mainloop_wait(data->mainloop);
+
+    if (pa_stream_get_state(data->stream) != PA_STREAM_READY) {
+      printf("AO: [pulse] Failed to connect to server: %s\n", pa_strerror(pa_context_errno(data->context)));
+      goto error_unlock;
+    }
+
+    pa_threaded_mainloop_unlock(data->mainloop);
 
     return ALC_TRUE;
+
+error_unlock:
+    pa_threaded_mainloop_unlock(data->mainloop);
+error_and_forced_exit:
+    pDevice->ExtraData = NULL;
+    pulse_destroy(data);
+    return ALC_FALSE;
 }
 
 static void PulseAudioCloseCapture(ALCdevice *pDevice) {
+    pulse_data *data = (pulse_data*)pDevice->ExtraData;
+
     AL_PRINT("alcPulseAudio PulseAudioCloseCapture\n");
-    (void)pDevice;
+
+    pulse_destroy(data);
+    pDevice->ExtraData = NULL;
+}
+
+static void pulse_cork(pulse_data *data, int cork) {
+    pa_operation *o;
+
+    pa_threaded_mainloop_lock(data->mainloop);
+    o = pa_stream_cork(data->stream, cork, NULL, NULL);
+    if (o)
+        pa_operation_unref(o);
+    pa_threaded_mainloop_unlock(data->mainloop);
 }
 
 static void PulseAudioStartCapture(ALCdevice *pDevice) {
-    AL_PRINT("alcPulseAudio PulseAudioStartCapture\n");
-    (void)pDevice;
+    pulse_cork((pulse_data*)pDevice->ExtraData, 0);
 }
 
 static void PulseAudioStopCapture(ALCdevice *pDevice) {
-    AL_PRINT("alcPulseAudio PulseAudioStopCapture\n");
-    (void)pDevice;
+    pulse_cork((pulse_data*)pDevice->ExtraData, 1);
 }
 
+// these only touch the ring, never the mainloop, so they don't wait on the
+// server
 static void PulseAudioCaptureSamples(ALCdevice *pDevice, ALCvoid *pBuffer, ALCuint lSamples) {
-    AL_PRINT("alcPulseAudio PulseAudioCaptureSamples\n");
-    (void)pDevice;
-    (void)pBuffer;
-    (void)lSamples;
+    pulse_data *data = (pulse_data*)pDevice->ExtraData;
+    if (lSamples <= (ALCuint)RingBufferSize(data->ring))
+        ReadRingBuffer(data->ring, pBuffer, lSamples);
+    else
+        SetALCError(ALC_INVALID_VALUE);
 }
 
 static ALCuint PulseAudioAvailableSamples(ALCdevice *pDevice) {
-    AL_PRINT("alcPulseAudio PulseAudioAvailableSamples\n");
-    (void)pDevice;
-    return ALC_TRUE;
+    pulse_data *data = (pulse_data*)pDevice->ExtraData;
+    return RingBufferSize(data->ring);
 }
 
 BackendFuncs PulseAudioFuncs = {
     PulseAudioOpenPlayback,
     PulseAudioClosePlayback,
+    NULL,
     PulseAudioOpenCapture,
     PulseAudioCloseCapture,
     PulseAudioStartCapture,
@@ -605,4 +778,5 @@ void alcPulseAudioInit(BackendFuncs *FuncList) {
 
     pulseaudio_playback_device = AppendDeviceList("PulseAudio Playback");
     AppendAllDeviceList(pulseaudio_playback_device);
+    pulseaudio_capture_device = AppendCaptureDeviceList("PulseAudio Capture");
 }
@@ -35,6 +35,10 @@ typedef struct {
     ALvoid *buffer;
     ALuint size;
 
+    // When false, updates are only rendered when the app calls
+    // alcProcessContext, instead of being paced against the clock
+    ALboolean realtime;
+
     int killNow;
     ALvoid *thread;
 } wave_data;
@@ -42,23 +46,72 @@ typedef struct {
 
 static ALCchar *waveDevice;
 
+// stdio buffer size for offline rendering, so the file is written in large
+// chunks no matter the update size
+#define OFFLINE_FILE_BUFFER (1<<20)
 
-static ALuint WaveProc(ALvoid *ptr)
+
+/* WAVE data is little-endian; swaps the byte order of each sample in place
+ * for big-endian hosts */
+static void SwapSampleBytes(ALvoid *buffer, ALuint samples, ALuint bytes)
+{
+    ALubyte *b = buffer;
+    ALubyte tmp;
+    ALuint i;
+
+    if(bytes == 2)
+    {
+        for(i = 0;i < samples;i++, b += 2)
+        {
+            tmp = b[0]; b[0] = b[1]; b[1] = tmp;
+        }
+    }
+    else if(bytes == 4)
+    {
+        for(i = 0;i < samples;i++, b += 4)
+        {
+            tmp = b[0]; b[0] = b[3]; b[3] = tmp;
+            tmp = b[1]; b[1] = b[2]; b[2] = tmp;
+        }
+    }
+}
+
+
+/* Renders the given number of frames, up to the buffer size, and writes them
+ * to the file */
+static ALboolean WriteFrames(ALCdevice *pDevice, ALuint frames)
 {
-    ALCdevice *pDevice = (ALCdevice*)ptr;
     wave_data *data = (wave_data*)pDevice->ExtraData;
-    ALuint frameSize;
-    ALuint now, last;
-    size_t WriteCnt;
-    ALuint avail;
+    ALuint frameSize, sampleSize;
     union {
         short s;
         char b[sizeof(short)];
     } uSB;
 
     uSB.s = 1;
-    frameSize = aluBytesFromFormat(pDevice->Format) *
-                aluChannelsFromFormat(pDevice->Format);
+    sampleSize = aluBytesFromFormat(pDevice->Format);
+    frameSize = sampleSize * aluChannelsFromFormat(pDevice->Format);
+
+    RenderDeviceData(pDevice, data->buffer, frames * frameSize);
+
+    if(uSB.b[0] != 1 && sampleSize > 1)
+        SwapSampleBytes(data->buffer, frames*frameSize/sampleSize, sampleSize);
+    fwrite(data->buffer, frameSize, frames, data->f);
+    if(ferror(data->f))
+    {
+        AL_PRINT("Error writing to file\n");
+        return AL_FALSE;
+    }
+    return AL_TRUE;
+}
+
+static ALuint WaveProc(ALvoid *ptr)
+{
+    ALCdevice *pDevice = (ALCdevice*)ptr;
+    wave_data *data = (wave_data*)pDevice->ExtraData;
+    ALuint now, last;
+    ALuint WriteCnt;
+    ALuint avail;
 
     last = timeGetTime();
     while(!data->killNow)
@@ -74,29 +127,12 @@ static ALuint WaveProc(ALvoid *ptr)
 
         while(avail > 0)
         {
-            SuspendContext(NULL);
             WriteCnt = min(data->size, avail);
-            aluMixData(pDevice->Context, data->buffer, WriteCnt * frameSize,
-                       pDevice->Format);
-            ProcessContext(NULL);
-
-            if(uSB.b[0] != 1 && aluBytesFromFormat(pDevice->Format) > 1)
+            if(!WriteFrames(pDevice, WriteCnt))
             {
-                ALubyte *bytes = data->buffer;
-                ALuint i;
-
-                for(i = 0;i < WriteCnt*frameSize;i++)
-                    fputc(bytes[i^1], data->f);
-            }
-            else
-                fwrite(data->buffer, frameSize, WriteCnt, data->f);
-            if(ferror(data->f))
-            {
-                AL_PRINT("Error writing to file\n");
                 data->killNow = 1;
                 break;
             }
-
             avail -= WriteCnt;
         }
         last = now;
@@ -105,12 +141,27 @@ static ALuint WaveProc(ALvoid *ptr)
     return 0;
 }
 
+/* Offline, there's no thread; each alcProcessContext call renders one update
+ * and writes it out before returning, so the same sequence of calls always
+ * produces the same file */
+static void wave_process_playback(ALCdevice *device)
+{
+    wave_data *data = (wave_data*)device->ExtraData;
+
+    if(data->realtime || data->killNow)
+        return;
+    if(!WriteFrames(device, data->size))
+        data->killNow = 1;
+}
+
 static ALCboolean wave_open_playback(ALCdevice *device, const ALCchar *deviceName)
 {
     wave_data *data;
     ALuint channels;
     ALuint bits;
+    ALuint formatTag;
     const char *fname;
+    const char *str;
     int i;
 
     fname = GetConfigValue("wave", "file", "");
@@ -136,12 +187,21 @@ static ALCboolean wave_open_playback(ALCdevice *device, const ALCchar *deviceNam
         return ALC_FALSE;
     }
 
+    str = GetConfigValue("wave", "realtime", "true");
+    data->realtime = (strcasecmp(str, "true") == 0 ||
+                      strcasecmp(str, "yes") == 0 ||
+                      strcasecmp(str, "on") == 0 ||
+                      atoi(str) != 0);
+    if(!data->realtime)
+        setvbuf(data->f, NULL, _IOFBF, OFFLINE_FILE_BUFFER);
+
     bits = aluBytesFromFormat(device->Format) * 8;
     channels = aluChannelsFromFormat(device->Format);
     switch(bits)
     {
         case 8:
         case 16:
+        case 32:
             if(channels == 0)
             {
                 AL_PRINT("Unknown format?! %x\n", device->Format);
@@ -158,6 +218,9 @@ static ALCboolean wave_open_playback(ALCdevice *device, const ALCchar *deviceNam
             return ALC_FALSE;
     }
 
+    // PCM: 1, IEEE float: 3
+    formatTag = ((bits == 32) ? 3 : 1);
+
     fprintf(data->f, "RIFF");
     fputc(0, data->f); // 'RIFF' header len; filled in at close
     fputc(0, data->f);
@@ -167,13 +230,15 @@ static ALCboolean wave_open_playback(ALCdevice *device, const ALCchar *deviceNam
     fprintf(data->f, "WAVE");
 
     fprintf(data->f, "fmt ");
-    fputc(16, data->f); // 'fmt ' header len; 16 bytes for PCM
+    // 'fmt ' header len; 16 bytes for PCM, 18 for non-PCM formats which
+    // carry an (empty) extension size
+    fputc((formatTag == 1) ? 16 : 18, data->f);
     fputc(0, data->f);
     fputc(0, data->f);
     fputc(0, data->f);
-    // 16-bit val, format type id (PCM: 1)
-    fputc(1, data->f);
-    fputc(0, data->f);
+    // 16-bit val, format type id
+    fputc(formatTag&0xff, data->f);
+    fputc((formatTag>>8)&0xff, data->f);
     // 16-bit val, channel count
     fputc(channels&0xff, data->f);
     fputc((channels>>8)&0xff, data->f);
@@ -195,6 +260,12 @@ static ALCboolean wave_open_playback(ALCdevice *device, const ALCchar *deviceNam
     // 16-bit val, bits per sample
     fputc(bits&0xff, data->f);
     fputc((bits>>8)&0xff, data->f);
+    if(formatTag != 1)
+    {
+        // 16-bit val, extension size
+        fputc(0, data->f);
+        fputc(0, data->f);
+    }
 
     fprintf(data->f, "data");
     fputc(0, data->f); // 'data' header len; filled in at close
@@ -224,7 +295,14 @@ static ALCboolean wave_open_playback(ALCdevice *device, const ALCchar *deviceNam
         return ALC_FALSE;
     }
 
+    // Offline, nothing is played back, so there's no deadline for a render
+    // queue to mix ahead of
+    device->Offline = !data->realtime;
+
     device->ExtraData = data;
+    if(device->Offline)
+        return ALC_TRUE;
+
     data->thread = StartThread(WaveProc, device);
     if(data->thread == NULL)
     {
@@ -244,12 +322,22 @@ static void wave_close_playback(ALCdevice *device)
     ALuint dataLen;
     long size;
 
-    data->killNow = 1;
-    StopThread(data->thread);
+    if(data->thread)
+    {
+        data->killNow = 1;
+        StopThread(data->thread);
+    }
 
     size = ftell(data->f);
     if(size > 0)
     {
+        // RIFF sizes are 32-bit; a longer offline render keeps its data,
+        // but readers will have to be told to ignore the header's length
+        if((unsigned long)size > 0xffffffffUL)
+        {
+            AL_PRINT("Output exceeds 4GB, header lengths will be capped\n");
+            size = 0xffffffffUL;
+        }
         dataLen = size - data->DataStart;
         if(fseek(data->f, data->DataStart-4, SEEK_SET) == 0)
         {
@@ -317,6 +405,7 @@ static ALCuint wave_available_samples(ALCdevice *pDevice)
 BackendFuncs wave_funcs = {
     wave_open_playback,
     wave_close_playback,
+    wave_process_playback,
     wave_open_capture,
     wave_close_capture,
     wave_start_capture,
@@ -413,6 +413,7 @@ static ALCuint WinMMAvailableSamples(ALCdevice *pDevice)
 BackendFuncs WinMMFuncs = {
     WinMMOpenPlayback,
     WinMMClosePlayback,
+    NULL,
     WinMMOpenCapture,
     WinMMCloseCapture,
     WinMMStartCapture,
@@ -2,6 +2,7 @@
 #define _AL_AUXEFFECTSLOT_H_
 
 #include "alEffect.h"
+#include "alu.h"
 #include "AL/al.h"
 
 #ifdef __cplusplus
@@ -14,6 +15,27 @@ extern "C" {
 
 #define AL_EFFECTSLOT_NULL                                 0x0000
 
+/* Processing state of a slot's effect. A state owns its buffers, and is
+ * created once for the effect type at the device frequency. Update is called
+ * from the API with the context locked, and works out everything Process
+ * needs. Process reads only the state and the slot's input bus, and adds
+ * whole blocks into the output, so one slot doesn't depend on any other. */
+typedef struct ALeffectState ALeffectState;
+struct ALeffectState {
+    ALvoid (*Destroy)(ALeffectState *State);
+    ALvoid (*Update)(ALeffectState *State, ALuint frequency, const ALeffect *Effect);
+    ALvoid (*Process)(ALeffectState *State, ALuint SamplesToDo, const ALfloat *SamplesIn, ALfloat (*SamplesOut)[OUTPUTCHANNELS]);
+};
+
+#define ALEffect_Destroy(a)         ((a)->Destroy((a)))
+#define ALEffect_Update(a,b,c)      ((a)->Update((a),(b),(c)))
+#define ALEffect_Process(a,b,c,d)   ((a)->Process((a),(b),(c),(d)))
+
+ALeffectState *ReverbCreate(ALuint frequency);
+ALeffectState *EchoCreate(ALuint frequency);
+ALeffectState *EqualizerCreate(ALuint frequency);
+ALeffectState *CompressorCreate(ALuint frequency);
+
 typedef struct ALeffectslot
 {
     ALeffect effect;
@@ -21,14 +43,10 @@ typedef struct ALeffectslot
     ALfloat Gain;
     ALboolean AuxSendAuto;
 
-    ALfloat *ReverbBuffer;
-    // in frames!
-    ALuint ReverbLength;
-    ALuint ReverbPos;
-    ALuint ReverbReflectPos;
-    ALuint ReverbLatePos;
-    ALfloat ReverbDecayGain;
-    ALfloat LastDecaySample;
+    ALeffectState *EffectState;
+
+    // Input bus, which every source send to this slot is mixed into
+    ALfloat WetBuffer[BUFFERSIZE];
 
     ALuint refcount;
 
@@ -11,6 +11,10 @@ extern "C" {
 #define PENDING   1
 #define PROCESSED 2
 
+// Number of pre-filtered, decimated copies (half and quarter rate) a buffer
+// can carry for high-pitch playback
+#define BUFFER_MIP_LEVELS 2
+
 typedef struct ALbuffer_struct 
 {
     ALenum   format;
@@ -20,9 +24,13 @@ typedef struct ALbuffer_struct
     ALsizei  frequency;
     ALenum   state;
     ALuint   refcount; // Number of sources using this buffer (deletion can only occur when this is 0)
+    ALshort *mipdata[BUFFER_MIP_LEVELS]; // Half/quarter-rate copies, made on first high-pitch use
     struct ALbuffer_struct *next;
 } ALbuffer;
 
+ALboolean GenerateBufferMips(ALbuffer *ALBuf);
+ALshort *GetBufferMipData(ALbuffer *ALBuf, ALuint level);
+ALsizei GetBufferMipFrames(ALbuffer *ALBuf, ALuint level);
 ALvoid ReleaseALBuffers(ALvoid);
 
 #ifdef __cplusplus
@@ -37,6 +37,31 @@ extern "C" {
 #define AL_REVERB_ROOM_ROLLOFF_FACTOR                      0x000C
 #define AL_REVERB_DECAY_HFLIMIT                            0x000D
 
+#define AL_REVERB_MAX_REFLECTIONS_DELAY                    0.3f
+#define AL_REVERB_MAX_LATE_REVERB_DELAY                    0.1f
+
+#define AL_ECHO_DELAY                                      0x0001
+#define AL_ECHO_LRDELAY                                    0x0002
+#define AL_ECHO_DAMPING                                    0x0003
+#define AL_ECHO_FEEDBACK                                   0x0004
+#define AL_ECHO_SPREAD                                     0x0005
+
+#define AL_ECHO_MAX_DELAY                                  0.207f
+#define AL_ECHO_MAX_LRDELAY                                0.404f
+
+#define AL_COMPRESSOR_ONOFF                                0x0001
+
+#define AL_EQUALIZER_LOW_GAIN                              0x0001
+#define AL_EQUALIZER_LOW_CUTOFF                            0x0002
+#define AL_EQUALIZER_MID1_GAIN                             0x0003
+#define AL_EQUALIZER_MID1_CENTER                           0x0004
+#define AL_EQUALIZER_MID1_WIDTH                            0x0005
+#define AL_EQUALIZER_MID2_GAIN                             0x0006
+#define AL_EQUALIZER_MID2_CENTER                           0x0007
+#define AL_EQUALIZER_MID2_WIDTH                            0x0008
+#define AL_EQUALIZER_HIGH_GAIN                             0x0009
+#define AL_EQUALIZER_HIGH_CUTOFF                           0x000A
+
 
 typedef struct ALeffect_struct
 {
@@ -60,6 +85,33 @@ typedef struct ALeffect_struct
         ALboolean DecayHFLimit;
     } Reverb;
 
+    struct {
+        ALfloat Delay;
+        ALfloat LRDelay;
+
+        ALfloat Damping;
+        ALfloat Feedback;
+
+        ALfloat Spread;
+    } Echo;
+
+    struct {
+        ALboolean OnOff;
+    } Compressor;
+
+    struct {
+        ALfloat LowGain;
+        ALfloat LowCutoff;
+        ALfloat Mid1Gain;
+        ALfloat Mid1Center;
+        ALfloat Mid1Width;
+        ALfloat Mid2Gain;
+        ALfloat Mid2Center;
+        ALfloat Mid2Width;
+        ALfloat HighGain;
+        ALfloat HighCutoff;
+    } Equalizer;
+
     // Index to itself
     ALuint effect;
 
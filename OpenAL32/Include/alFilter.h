@@ -2,6 +2,7 @@
 #define _AL_FILTER_H_
 
 #include "AL/al.h"
+#include "alu.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -17,6 +18,18 @@ extern "C" {
 #define AL_LOWPASS_GAIN                                    0x0001
 #define AL_LOWPASS_GAINHF                                  0x0002
 
+#define AL_HIGHPASS_GAIN                                   0x0001
+#define AL_HIGHPASS_GAINLF                                 0x0002
+
+#define AL_BANDPASS_GAIN                                   0x0001
+#define AL_BANDPASS_GAINLF                                 0x0002
+#define AL_BANDPASS_GAINHF                                 0x0003
+
+/* Shelf frequencies of the filters, in hz. GainHF applies above the
+ * lowpass one, and GainLF below the highpass one. */
+#define LOWPASS_FREQUENCY                                  5000.0f
+#define HIGHPASS_FREQUENCY                                 250.0f
+
 
 typedef struct ALfilter_struct
 {
@@ -25,6 +38,7 @@ typedef struct ALfilter_struct
 
     ALfloat Gain;
     ALfloat GainHF;
+    ALfloat GainLF;
 
     // Index to itself
     ALuint filter;
@@ -32,6 +46,134 @@ typedef struct ALfilter_struct
     struct ALfilter_struct *next;
 } ALfilter;
 
+/* Biquad stages of a filtered path */
+#define FILTER_HF 0
+#define FILTER_LF 1
+
+/* Transposed direct form II biquad coefficients, normalized to a0 = 1 */
+typedef struct ALbiquad
+{
+    ALfloat b0, b1, b2;
+    ALfloat a1, a2;
+} ALbiquad;
+
+#ifdef HAVE_SSE2
+/* Loads or stores the first n (1 to 4) floats at p as the low lanes of a
+ * vector */
+static __inline __m128 aluLoadLanes(const ALfloat *p, ALuint n)
+{
+    switch(n)
+    {
+        case 4: return _mm_loadu_ps(p);
+        case 3: return _mm_movelh_ps(_mm_loadl_pi(_mm_setzero_ps(), (const __m64*)p),
+                                     _mm_load_ss(p+2));
+        case 2: return _mm_loadl_pi(_mm_setzero_ps(), (const __m64*)p);
+    }
+    return _mm_load_ss(p);
+}
+
+static __inline ALvoid aluStoreLanes(ALfloat *p, __m128 v, ALuint n)
+{
+    switch(n)
+    {
+        case 4: _mm_storeu_ps(p, v); break;
+        case 3: _mm_storel_pi((__m64*)p, v);
+                _mm_store_ss(p+2, _mm_movehl_ps(v, v)); break;
+        case 2: _mm_storel_pi((__m64*)p, v); break;
+        default: _mm_store_ss(p, v); break;
+    }
+}
+#endif
+
+/* Runs a block of interleaved samples through a biquad, in place, with one
+ * history per channel. Each sample depends on the one before it, so with SSE2
+ * the channels are what's run in parallel: up to eight per pass, as two
+ * vectors whose lanes each keep their own history. Lanes do the same math as
+ * the plain loop, so the results match it exactly. The histories are flushed
+ * after every block, so a silent tail can't leave them decaying through
+ * denormals for longer than one block. */
+static __inline ALvoid aluFilterBlock(const ALbiquad *f, ALfloat *z1, ALfloat *z2,
+                                      ALfloat *data, ALuint stride,
+                                      ALuint channels, ALuint todo)
+{
+    ALfloat b0 = f->b0, b1 = f->b1, b2 = f->b2;
+    ALfloat a1 = f->a1, a2 = f->a2;
+    ALuint i, c, first = 0;
+
+#ifdef HAVE_SSE2
+    const __m128 vb0 = _mm_set1_ps(b0), vb1 = _mm_set1_ps(b1);
+    const __m128 vb2 = _mm_set1_ps(b2);
+    const __m128 va1 = _mm_set1_ps(a1), va2 = _mm_set1_ps(a2);
+    __m128 x, y, lo1, lo2, hi1, hi2;
+    ALuint lo, hi;
+
+    // A lone channel gains nothing from a vector
+    for(;channels > 1 && first < channels;first += lo+hi)
+    {
+        lo = channels-first;
+        if(lo > 8) lo = 8;
+        hi = ((lo > 4) ? lo-4 : 0);
+        lo -= hi;
+
+        lo1 = aluLoadLanes(&z1[first], lo);
+        lo2 = aluLoadLanes(&z2[first], lo);
+        if(!hi)
+        {
+            for(i = 0;i < todo;i++)
+            {
+                ALfloat *d = &data[i*stride + first];
+                x = aluLoadLanes(d, lo);
+                y = _mm_add_ps(_mm_mul_ps(vb0, x), lo1);
+                lo1 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(vb1, x), _mm_mul_ps(va1, y)), lo2);
+                lo2 = _mm_sub_ps(_mm_mul_ps(vb2, x), _mm_mul_ps(va2, y));
+                aluStoreLanes(d, y, lo);
+            }
+        }
+        else
+        {
+            hi1 = aluLoadLanes(&z1[first+4], hi);
+            hi2 = aluLoadLanes(&z2[first+4], hi);
+            for(i = 0;i < todo;i++)
+            {
+                ALfloat *d = &data[i*stride + first];
+                x = _mm_loadu_ps(d);
+                y = _mm_add_ps(_mm_mul_ps(vb0, x), lo1);
+                lo1 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(vb1, x), _mm_mul_ps(va1, y)), lo2);
+                lo2 = _mm_sub_ps(_mm_mul_ps(vb2, x), _mm_mul_ps(va2, y));
+                _mm_storeu_ps(d, y);
+
+                x = aluLoadLanes(d+4, hi);
+                y = _mm_add_ps(_mm_mul_ps(vb0, x), hi1);
+                hi1 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(vb1, x), _mm_mul_ps(va1, y)), hi2);
+                hi2 = _mm_sub_ps(_mm_mul_ps(vb2, x), _mm_mul_ps(va2, y));
+                aluStoreLanes(d+4, y, hi);
+            }
+            aluStoreLanes(&z1[first+4], hi1, hi);
+            aluStoreLanes(&z2[first+4], hi2, hi);
+        }
+        aluStoreLanes(&z1[first], lo1, lo);
+        aluStoreLanes(&z2[first], lo2, lo);
+    }
+#endif
+    for(i = 0;first < channels && i < todo;i++)
+    {
+        ALfloat *d = &data[i*stride];
+        for(c = first;c < channels;c++)
+        {
+            ALfloat x = d[c];
+            ALfloat y = b0*x + z1[c];
+            z1[c] = b1*x - a1*y + z2[c];
+            z2[c] = b2*x - a2*y;
+            d[c] = y;
+        }
+    }
+    for(c = 0;c < channels;c++)
+    {
+        z1[c] = aluFlushDenormal(z1[c]);
+        z2[c] = aluFlushDenormal(z2[c]);
+    }
+}
+
 AL_API ALvoid AL_APIENTRY alGenFilters(ALsizei n, ALuint *filters);
 AL_API ALvoid AL_APIENTRY alDeleteFilters(ALsizei n, ALuint *filters);
 AL_API ALboolean AL_APIENTRY alIsFilter(ALuint filter);
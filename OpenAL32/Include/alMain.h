@@ -121,6 +121,8 @@ extern char _alDebug[256];
 typedef struct {
     ALCboolean (*OpenPlayback)(ALCdevice*, const ALCchar*);
     void (*ClosePlayback)(ALCdevice*);
+    // Renders the next update of an offline device (NULL if never offline)
+    void (*ProcessPlayback)(ALCdevice*);
 
     ALCboolean (*OpenCapture)(ALCdevice*, const ALCchar*, ALCuint, ALCenum, ALCsizei);
     void (*CloseCapture)(ALCdevice*);
@@ -150,10 +152,23 @@ struct ALCdevice_struct
 
     // Maximum number of sources that can be created
     ALuint       MaxNoOfSources;
+    // Maximum number of sources mixed at once (0 = no limit)
+    ALuint       MaxVoices;
+    ALuint       NumAuxSends;
 
     // Context created on this device
     ALCcontext   *Context;
 
+    // Capture statistics, kept up to date by backends that can
+    ALuint       CaptureDelay; // Frames buffered by the device, outside the ring
+    ALuint       CaptureOverruns;
+
+    // Mixes playback ahead on its own thread (NULL when mixing inline)
+    struct RenderQueue *RenderQueue;
+    // Set by backends that render only when the app calls alcProcessContext,
+    // rather than in real time, and so never mix ahead
+    ALboolean    Offline;
+
     BackendFuncs *Funcs;
     void         *ExtraData; // For the backend's use
 
@@ -162,6 +177,7 @@ struct ALCdevice_struct
 
 #define ALCdevice_OpenPlayback(a,b)      ((a)->Funcs->OpenPlayback((a), (b)))
 #define ALCdevice_ClosePlayback(a)       ((a)->Funcs->ClosePlayback((a)))
+#define ALCdevice_ProcessPlayback(a)     ((a)->Funcs->ProcessPlayback((a)))
 #define ALCdevice_OpenCapture(a,b,c,d,e) ((a)->Funcs->OpenCapture((a), (b), (c), (d), (e)))
 #define ALCdevice_CloseCapture(a)        ((a)->Funcs->CloseCapture((a)))
 #define ALCdevice_StartCapture(a)        ((a)->Funcs->StartCapture((a)))
@@ -193,6 +209,19 @@ struct ALCcontext_struct
     ALint       lNumMonoSources;
     ALint       lNumStereoSources;
 
+    ALfloat     VoiceCullGain;
+
+    // Scratch list used to rank playing sources against the voice limit
+    struct ALsource **VoiceList;
+    ALuint            VoiceListSize;
+
+    // Hashed uniform grid of positional sources (NULL when disabled)
+    struct ALsource **SourceGrid;
+    ALfloat           GridCellSize;
+    ALfloat           GridMaxRadius;
+    ALboolean         GridMaxDirty;
+    ALuint            GridStamp;
+
     ALCdevice  *Device;
     ALCchar     ExtensionList[1024];
 
@@ -214,13 +243,28 @@ ALCvoid ProcessContext(ALCcontext *context);
 
 ALvoid *StartThread(ALuint (*func)(ALvoid*), ALvoid *ptr);
 ALuint StopThread(ALvoid *thread);
+void SetMixerThreadAttributes(void);
 
 typedef struct RingBuffer RingBuffer;
+typedef struct RingBufferRegion {
+    ALubyte *ptr;
+    ALsizei len;
+} RingBufferRegion;
 RingBuffer *CreateRingBuffer(ALsizei frame_size, ALsizei length);
 void DestroyRingBuffer(RingBuffer *ring);
 ALsizei RingBufferSize(RingBuffer *ring);
-void WriteRingBuffer(RingBuffer *ring, const ALubyte *data, ALsizei len);
-void ReadRingBuffer(RingBuffer *ring, ALubyte *data, ALsizei len);
+ALsizei RingBufferSpace(RingBuffer *ring);
+ALsizei WriteRingBuffer(RingBuffer *ring, const ALubyte *data, ALsizei len);
+ALsizei ReadRingBuffer(RingBuffer *ring, ALubyte *data, ALsizei len);
+ALsizei PeekWriteRingBuffer(RingBuffer *ring, RingBufferRegion regions[2]);
+void CommitWriteRingBuffer(RingBuffer *ring, ALsizei len);
+ALsizei PeekReadRingBuffer(RingBuffer *ring, RingBufferRegion regions[2]);
+void CommitReadRingBuffer(RingBuffer *ring, ALsizei len);
+
+typedef struct RenderQueue RenderQueue;
+ALCboolean StartRenderQueue(ALCdevice *device, ALuint updates);
+ALCvoid StopRenderQueue(ALCdevice *device);
+ALvoid RenderDeviceData(ALCdevice *device, ALvoid *buffer, ALsizei size);
 
 void ReadALConfig(void);
 void FreeALConfig(void);
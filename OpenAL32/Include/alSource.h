@@ -3,10 +3,11 @@
 
 #define AL_NUM_SOURCE_PARAMS    128
 
-/* This cannot be changed without working on the code! */
-#define MAX_SENDS                 1
+/* Most auxiliary sends a device can be configured with */
+#define MAX_SENDS                 4
 
 #include "alFilter.h"
+#include "alu.h"
 #include "AL/al.h"
 
 #define AL_DIRECT_FILTER                                   0x20005
@@ -18,6 +19,11 @@
 #define AL_AUXILIARY_SEND_FILTER_GAIN_AUTO                 0x2000B
 #define AL_AUXILIARY_SEND_FILTER_GAINHF_AUTO               0x2000C
 
+/* Number of hash buckets in the optional source grid (power of 2) */
+#define GRID_BUCKETS 1024
+#define GRID_HASH(x,y,z) ((((ALuint)(x)*73856093u) ^ ((ALuint)(y)*19349663u) ^ \
+                           ((ALuint)(z)*83492791u)) & (GRID_BUCKETS-1))
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -70,18 +76,56 @@ typedef struct ALsource
         ALfilter WetFilter;
     } Send[MAX_SENDS];
 
-    ALfloat LastDrySample;
-    ALfloat LastWetSample;
+    // Biquad histories, [stage][z1/z2][channel] for the direct path, and
+    // [send][stage][z1/z2] for the sends, which are mono
+    ALfloat DryFilterState[2][2][OUTPUTCHANNELS];
+    ALfloat WetFilterState[MAX_SENDS][2][2];
 
     ALboolean DryGainHFAuto;
     ALboolean WetGainAuto;
     ALboolean WetGainHFAuto;
     ALfloat   OuterGainHF;
 
+    // Cosines of the cone angles, for the mixer's cone test
+    ALfloat CosInnerAngle;
+    ALfloat CosOuterAngle;
+
     ALfloat AirAbsorptionFactor;
 
+    // Parameters calculated by the mixer at the start of each update
+    struct {
+        ALfloat DrySend[OUTPUTCHANNELS];
+        ALbiquad DryFilter[2];
+        ALboolean DryFilterOn[2];
+        struct {
+            ALfloat WetGain;
+            ALbiquad WetFilter[2];
+            ALboolean WetFilterOn[2];
+        } Send[MAX_SENDS];
+        ALfloat Pitch;
+        // Channel count of the buffer they were calculated for
+        ALuint Channels;
+    } Params;
+
     ALfloat RoomRolloffFactor;
 
+    // Set by the mixer when the source is too quiet to be heard, or loses
+    // out to other sources under the voice limit, in which case only its
+    // playback position is advanced
+    ALboolean IsVirtual;
+    ALboolean VoiceLimited;
+    ALfloat   Audibility; // Total send gain for the current update
+    ALint     Priority;
+
+    // Source grid state. Sources in the grid are known to be inaudible
+    // beyond CullRadius, and are only processed by the mixer when the grid
+    // query stamps them as being in range of the listener.
+    ALboolean InGrid;
+    ALint     GridCell[3];
+    ALfloat   CullRadius;
+    ALuint    GridStamp;
+    struct ALsource *GridNext;
+
     // Index to itself
     ALuint source;
 
@@ -96,6 +140,9 @@ typedef struct ALsource
     struct ALsource *next;
 } ALsource;
 
+ALint GetGridCoord(ALfloat pos, ALfloat CellSize);
+ALvoid UpdateSourceGrid(ALCcontext *Context, ALsource *Source);
+ALvoid RefreshSourceGrid(ALCcontext *Context);
 ALvoid ReleaseALSources(ALCcontext *Context);
 
 #ifdef __cplusplus
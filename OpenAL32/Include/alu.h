@@ -1,18 +1,217 @@
 #ifndef _ALU_H_
 #define _ALU_H_
 
+#include <math.h>
+
 #include "AL/al.h"
 #include "AL/alc.h"
 
+#if defined(HAVE_EMMINTRIN_H) && (defined(__SSE2__) || defined(_M_X64) || \
+                                   (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define HAVE_SSE2
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/* Most samples mixed in one pass */
+#define BUFFERSIZE 48000
+
+#ifdef HAVE_SQRTF
+#define aluSqrt(x) ((ALfloat)sqrtf((float)(x)))
+#else
+#define aluSqrt(x) ((ALfloat)sqrt((double)(x)))
+#endif
+
+enum {
+    FRONT_LEFT = 0,
+    FRONT_RIGHT,
+    SIDE_LEFT,
+    SIDE_RIGHT,
+    BACK_LEFT,
+    BACK_RIGHT,
+    CENTER,
+    LFE,
+
+    OUTPUTCHANNELS
+};
+
+/* Recursive filter state below this is inaudible, and is flushed to zero
+ * before it decays into denormals, which are slow on many FPUs */
+#define DENORMAL_THRESHOLD (1e-20f)
+
 extern ALboolean DuplicateStereo;
+extern ALboolean ClampFloatOutput;
+
+static __inline ALfloat aluFlushDenormal(ALfloat value)
+{
+    if(value < DENORMAL_THRESHOLD && value > -DENORMAL_THRESHOLD)
+        return 0.0f;
+    return value;
+}
+
+/* Constant-power panning gains, sqrt(x) for x in [0,1]. Panning between two
+ * speakers splits into a product of these, and linear interpolation keeps
+ * the absolute gain error under 0.006. */
+#define PANTABLE_SIZE 2048
+extern ALfloat aluPanTable[PANTABLE_SIZE+1];
+
+static __inline ALvoid aluInitPanning(ALvoid)
+{
+    ALuint i;
+
+    for(i = 0;i <= PANTABLE_SIZE;i++)
+        aluPanTable[i] = (ALfloat)sqrt((double)i / PANTABLE_SIZE);
+}
+
+static __inline ALfloat aluPanGain(ALfloat x)
+{
+    ALfloat pos;
+    ALint i;
+
+    pos = ((x > 0.0f) ? ((x < 1.0f) ? x : 1.0f) : 0.0f) * PANTABLE_SIZE;
+    i = (ALint)pos;
+    if(i > PANTABLE_SIZE-1)
+        i = PANTABLE_SIZE-1;
+    pos -= i;
+    return aluPanTable[i] + (aluPanTable[i+1]-aluPanTable[i])*pos;
+}
+
+/* Float approximations of log2, exp2 and pow for the attenuation math. For
+ * positive x, the relative error of aluFastPow stays around 1e-5 for results
+ * in the range of normal floats. */
+typedef union {
+    ALfloat f;
+    ALuint  i;
+} ALfloatbits;
+
+static __inline ALfloat aluFastLog2(ALfloat x)
+{
+    ALfloatbits v;
+    ALfloat e, t, t2;
+
+    v.f = x;
+    e = (ALfloat)((ALint)((v.i>>23)&0xff) - 127);
+    v.i = (v.i&0x007fffff) | 0x3f800000;
+
+    // log2(m) = 2/ln(2) * atanh((m-1)/(m+1)), m in [1,2)
+    t = (v.f-1.0f) / (v.f+1.0f);
+    t2 = t*t;
+    return e + t*(2.88539008f + t2*(0.96179669f + t2*(0.57707801f +
+                                    t2*(0.41219858f + t2*0.32059889f))));
+}
+
+static __inline ALfloat aluFastExp2(ALfloat x)
+{
+    ALfloatbits v;
+    ALfloat f;
+    ALint n;
+
+    if(x < -126.0f) x = -126.0f;
+    if(x >  127.0f) x =  127.0f;
+    n = (ALint)x;
+    if((ALfloat)n > x)
+        n--;
+    f = x - (ALfloat)n;
+
+    // 2^f, f in [0,1)
+    v.f = 1.0f + f*(0.69314718f + f*(0.24022651f + f*(0.05550411f +
+                    f*(0.00961813f + f*(0.00133336f + f*0.00015404f)))));
+    v.i += (ALuint)n << 23;
+    return v.f;
+}
+
+static __inline ALfloat aluFastPow(ALfloat x, ALfloat y)
+{
+    if(x <= 0.0f)
+        return 0.0f;
+    return aluFastExp2(y * aluFastLog2(x));
+}
+
+#ifdef HAVE_SSE2
+/* aluFastPow on four values at once. It takes the same steps in the same
+ * order, so each lane gives exactly what aluFastPow would. */
+static __inline __m128 aluFastPow4(__m128 x, __m128 y)
+{
+    const __m128 one = _mm_set1_ps(1.0f);
+    __m128 e, v, t, t2, f;
+    __m128i bits, n;
+
+    // aluFastLog2
+    bits = _mm_castps_si128(x);
+    e = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_and_si128(_mm_srli_epi32(bits, 23),
+                                                    _mm_set1_epi32(0xff)),
+                                      _mm_set1_epi32(127)));
+    v = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007fffff)),
+                                      _mm_set1_epi32(0x3f800000)));
+    t = _mm_div_ps(_mm_sub_ps(v, one), _mm_add_ps(v, one));
+    t2 = _mm_mul_ps(t, t);
+    v = _mm_add_ps(_mm_set1_ps(0.41219858f), _mm_mul_ps(t2, _mm_set1_ps(0.32059889f)));
+    v = _mm_add_ps(_mm_set1_ps(0.57707801f), _mm_mul_ps(t2, v));
+    v = _mm_add_ps(_mm_set1_ps(0.96179669f), _mm_mul_ps(t2, v));
+    v = _mm_add_ps(_mm_set1_ps(2.88539008f), _mm_mul_ps(t2, v));
+    t = _mm_mul_ps(y, _mm_add_ps(e, _mm_mul_ps(t, v)));
+
+    // aluFastExp2
+    t = _mm_min_ps(_mm_max_ps(t, _mm_set1_ps(-126.0f)), _mm_set1_ps(127.0f));
+    n = _mm_cvttps_epi32(t);
+    n = _mm_add_epi32(n, _mm_castps_si128(_mm_cmpgt_ps(_mm_cvtepi32_ps(n), t)));
+    f = _mm_sub_ps(t, _mm_cvtepi32_ps(n));
+    v = _mm_add_ps(_mm_set1_ps(0.00133336f), _mm_mul_ps(f, _mm_set1_ps(0.00015404f)));
+    v = _mm_add_ps(_mm_set1_ps(0.00961813f), _mm_mul_ps(f, v));
+    v = _mm_add_ps(_mm_set1_ps(0.05550411f), _mm_mul_ps(f, v));
+    v = _mm_add_ps(_mm_set1_ps(0.24022651f), _mm_mul_ps(f, v));
+    v = _mm_add_ps(_mm_set1_ps(0.69314718f), _mm_mul_ps(f, v));
+    v = _mm_add_ps(one, _mm_mul_ps(f, v));
+    v = _mm_castsi128_ps(_mm_add_epi32(_mm_castps_si128(v), _mm_slli_epi32(n, 23)));
+
+    return _mm_andnot_ps(_mm_cmple_ps(x, _mm_setzero_ps()), v);
+}
+#endif
+
+/* Returns the cosine of a cone angle, which the mixer compares directly
+ * against the dot product of the source direction and the direction to the
+ * listener. Angles past 180 degrees, which the angle between the two can't
+ * reach, are extended linearly below -1 so they stay ordered. */
+static __inline ALfloat aluConeAngleCos(ALfloat angle)
+{
+    if(angle > 180.0f)
+        return -1.0f - (angle-180.0f)/90.0f;
+    return (ALfloat)cos(angle * 3.14159265358979323846 / 180.0);
+}
+
+/* Returns how far outside the cone the listener is, from 0 inside the inner
+ * cone to 1 outside the outer cone. The cosines decide which side of the
+ * cones the listener is on; only between the two is the angle worked out, to
+ * interpolate on it. */
+static __inline ALfloat aluConeScale(ALfloat CosAngle, ALfloat CosInner, ALfloat CosOuter,
+                                     ALfloat InnerAngle, ALfloat OuterAngle)
+{
+    ALfloat Angle;
+
+    if(CosAngle <= CosInner && CosAngle >= CosOuter)
+    {
+        Angle = (ALfloat)(acos((CosAngle > -1.0f) ? CosAngle : -1.0f) * 180.0 /
+                          3.14159265358979323846);
+        // rounding may put the angle just outside the cones
+        if(Angle <= InnerAngle)
+            return 0.0f;
+        if(Angle >= OuterAngle)
+            return 1.0f;
+        return (Angle-InnerAngle) / (OuterAngle-InnerAngle);
+    }
+    if(CosAngle < CosOuter)
+        return 1.0f;
+    return 0.0f;
+}
+
 
 __inline ALuint aluBytesFromFormat(ALenum format);
 __inline ALuint aluChannelsFromFormat(ALenum format);
 ALvoid aluMixData(ALCcontext *context,ALvoid *buffer,ALsizei size,ALenum format);
+ALvoid aluLockMixBuffers(ALvoid);
 
 #ifdef __cplusplus
 }
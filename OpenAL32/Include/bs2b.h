@@ -51,24 +51,32 @@ struct bs2b {
     int srate;   /* Sample rate (Hz) */
 
     /* Lowpass IIR filter coefficients */
-    double a0_lo;
-    double b1_lo;
+    float a0_lo;
+    float b1_lo;
 
     /* Highboost IIR filter coefficients */
-    double a0_hi;
-    double a1_hi;
-    double b1_hi;
+    float a0_hi;
+    float a1_hi;
+    float b1_hi;
+
+    /* Coefficients for two samples at a time, which run both outputs
+     * from the one before them.
+     * lo2: b1_lo*a0_lo, b1_lo^2
+     * hi2: a1_hi + b1_hi*a0_hi, b1_hi*a1_hi, b1_hi^2
+     */
+    float lo2[2];
+    float hi2[3];
 
     /* Global gain against overloading */
-    double gain;
+    float gain;
 
     /* Buffer of last filtered sample.
      * [0] - first channel, [1] - second channel
      */
     struct t_last_sample {
-        double asis[2];
-        double lo[2];
-        double hi[2];
+        float asis[2];
+        float lo[2];
+        float hi[2];
     } last_sample;
 };
 
@@ -102,6 +110,13 @@ int bs2b_is_clear(struct bs2b *bs2b);
 /* sample poits to floats */
 void bs2b_cross_feed(struct bs2b *bs2b, float *sample);
 
+/* Crossfeeds a block of todo stereo samples in place.
+ * left and right point to the first sample of each channel, and the
+ * samples of a channel are stride floats apart (1 for planar buffers).
+ */
+void bs2b_cross_feed_block(struct bs2b *bs2b, float *left, float *right,
+                           int stride, int todo);
+
 #ifdef __cplusplus
 }    /* extern "C" */
 #endif /* __cplusplus */
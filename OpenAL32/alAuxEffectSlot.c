@@ -49,44 +49,38 @@ AL_API ALvoid AL_APIENTRY alGenAuxiliaryEffectSlots(ALsizei n, ALuint *effectslo
 
     if (n > 0)
     {
-        /* NOTE: We only support one slot currently */
-        if(n == 1 && Context->AuxiliaryEffectSlotCount == 0)
+        // Check that enough memory has been allocted in the 'effectslots' array for n Effect Slots
+        if (!IsBadWritePtr((void*)effectslots, n * sizeof(ALuint)))
         {
-            // Check that enough memory has been allocted in the 'effectslots' array for n Effect Slots
-            if (!IsBadWritePtr((void*)effectslots, n * sizeof(ALuint)))
-            {
-                ALeffectslot **list = &Context->AuxiliaryEffectSlot;
-                while(*list)
-                    list = &(*list)->next;
+            ALeffectslot **list = &Context->AuxiliaryEffectSlot;
+            while(*list)
+                list = &(*list)->next;
 
-                i = 0;
-                while(i < n)
+            i = 0;
+            while(i < n)
+            {
+                *list = calloc(1, sizeof(ALeffectslot));
+                if(!(*list))
                 {
-                    *list = calloc(1, sizeof(ALeffectslot));
-                    if(!(*list))
-                    {
-                        // We must have run out or memory
-                        alDeleteAuxiliaryEffectSlots(i, effectslots);
-                        alSetError(AL_OUT_OF_MEMORY);
-                        break;
-                    }
-
-                    (*list)->Gain = 1.0;
-                    (*list)->AuxSendAuto = AL_TRUE;
-                    (*list)->refcount = 0;
-
-                    effectslots[i] = (ALuint)ALTHUNK_ADDENTRY(*list);
-                    (*list)->effectslot = effectslots[i];
-
-                    Context->AuxiliaryEffectSlotCount++;
-                    i++;
-
-                    list = &(*list)->next;
+                    // We must have run out or memory
+                    alDeleteAuxiliaryEffectSlots(i, effectslots);
+                    alSetError(AL_OUT_OF_MEMORY);
+                    break;
                 }
+
+                (*list)->Gain = 1.0;
+                (*list)->AuxSendAuto = AL_TRUE;
+                (*list)->refcount = 0;
+
+                effectslots[i] = (ALuint)ALTHUNK_ADDENTRY(*list);
+                (*list)->effectslot = effectslots[i];
+
+                Context->AuxiliaryEffectSlotCount++;
+                i++;
+
+                list = &(*list)->next;
             }
         }
-        else
-            alSetError(AL_INVALID_OPERATION);
     }
 
     ProcessContext(Context);
@@ -148,7 +142,8 @@ AL_API ALvoid AL_APIENTRY alDeleteAuxiliaryEffectSlots(ALsizei n, ALuint *effect
                         *list = (*list)->next;
                     ALTHUNK_REMOVEENTRY(ALAuxiliaryEffectSlot->effectslot);
 
-                    free(ALAuxiliaryEffectSlot->ReverbBuffer);
+                    if(ALAuxiliaryEffectSlot->EffectState)
+                        ALEffect_Destroy(ALAuxiliaryEffectSlot->EffectState);
 
                     memset(ALAuxiliaryEffectSlot, 0, sizeof(ALeffectslot));
                     free(ALAuxiliaryEffectSlot);
@@ -467,54 +462,52 @@ AL_API ALvoid AL_APIENTRY alGetAuxiliaryEffectSlotfv(ALuint effectslot, ALenum p
 
 static ALvoid InitializeEffect(ALCcontext *Context, ALeffectslot *ALEffectSlot, ALeffect *effect)
 {
-    ALfloat *ptr = NULL;
+    ALeffectState *State = ALEffectSlot->EffectState;
+    ALenum type = (effect ? effect->type : AL_EFFECT_NULL);
+
+    // A new state is only made when the effect type changes. Changes to the
+    // same type just update the existing one
+    if(State && ALEffectSlot->effect.type != type)
+    {
+        ALEffect_Destroy(State);
+        State = ALEffectSlot->EffectState = NULL;
+    }
 
     if(!effect)
     {
         memset(&ALEffectSlot->effect, 0, sizeof(ALEffectSlot->effect));
-        goto done;
+        return;
     }
 
-    if(effect->type == AL_EFFECT_REVERB)
+    if(!State)
     {
-        ALuint size;
-        ALfloat reverbwait;
-
-        reverbwait = (1.0f-effect->Reverb.Density)*(0.1f-0.075f) + 0.075f;
-
-        size = (ALuint)((ALfloat)Context->Frequency *
-                        (effect->Reverb.ReflectionsDelay +
-                         effect->Reverb.LateReverbDelay +
-                         reverbwait)) + 1;
-
-        ptr = calloc(size, sizeof(ALfloat));
-        if(!ptr)
+        switch(type)
+        {
+            case AL_EFFECT_REVERB:
+                State = ReverbCreate(Context->Frequency);
+                break;
+            case AL_EFFECT_ECHO:
+                State = EchoCreate(Context->Frequency);
+                break;
+            case AL_EFFECT_EQUALIZER:
+                State = EqualizerCreate(Context->Frequency);
+                break;
+            case AL_EFFECT_COMPRESSOR:
+                State = CompressorCreate(Context->Frequency);
+                break;
+        }
+        if(!State && type != AL_EFFECT_NULL)
         {
             alSetError(AL_OUT_OF_MEMORY);
+            memset(&ALEffectSlot->effect, 0, sizeof(ALEffectSlot->effect));
             return;
         }
-        if(ALEffectSlot->ReverbBuffer)
-            memcpy(ptr, ALEffectSlot->ReverbBuffer, min(size, ALEffectSlot->ReverbLength)*sizeof(ALfloat));
-        ALEffectSlot->ReverbLength = size;
-        ALEffectSlot->ReverbPos %= size;
-        ALEffectSlot->ReverbReflectPos = (ALuint)(ALEffectSlot->ReverbLength -
-                                          ((ALfloat)Context->Frequency *
-                                           effect->Reverb.ReflectionsDelay) +
-                                          ALEffectSlot->ReverbPos) %
-                                         ALEffectSlot->ReverbLength;
-        ALEffectSlot->ReverbLatePos = (ALuint)(ALEffectSlot->ReverbLength -
-                                               ((ALfloat)Context->Frequency *
-                                              (effect->Reverb.LateReverbDelay +
-                                           effect->Reverb.ReflectionsDelay)) +
-                                          ALEffectSlot->ReverbPos) %
-                                         ALEffectSlot->ReverbLength;
-        ALEffectSlot->ReverbDecayGain = pow(1.0/32768.0, 1.0/(effect->Reverb.DecayTime/reverbwait));
+        ALEffectSlot->EffectState = State;
     }
+    if(State)
+        ALEffect_Update(State, Context->Frequency, effect);
 
     memcpy(&ALEffectSlot->effect, effect, sizeof(*effect));
-done:
-    free(ALEffectSlot->ReverbBuffer);
-    ALEffectSlot->ReverbBuffer = ptr;
 }
 
 
@@ -531,7 +524,8 @@ ALvoid ReleaseALAuxiliaryEffectSlots(ALCcontext *Context)
         Context->AuxiliaryEffectSlot = Context->AuxiliaryEffectSlot->next;
 
         // Release effectslot structure
-        free(temp->ReverbBuffer);
+        if(temp->EffectState)
+            ALEffect_Destroy(temp->EffectState);
         ALTHUNK_REMOVEENTRY(temp->effectslot);
 
         memset(temp, 0, sizeof(ALeffectslot));
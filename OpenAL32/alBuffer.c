@@ -34,6 +34,7 @@
 
 
 static void LoadData(ALbuffer *ALBuf, const ALubyte *data, ALsizei size, ALuint freq, ALenum OrigFormat, ALenum NewFormat);
+static void ReleaseBufferMips(ALbuffer *ALBuf);
 
 /*
  *  AL Buffer Functions
@@ -187,6 +188,7 @@ ALAPI ALvoid ALAPIENTRY alDeleteBuffers(ALsizei n, const ALuint *puiBuffers)
 
                         // Release the memory used to store audio data
                         free(ALBuf->data);
+                        ReleaseBufferMips(ALBuf);
 
                         // Release buffer structure
                         ALTHUNK_REMOVEENTRY(puiBuffers[i]);
@@ -276,6 +278,9 @@ ALAPI ALvoid ALAPIENTRY alBufferData(ALuint buffer,ALenum format,const ALvoid *d
         ALBuf=((ALbuffer *)ALTHUNK_LOOKUPENTRY(buffer));
         if ((ALBuf->refcount==0)&&(data))
         {
+            // Any decimated copies are stale once the data changes
+            ReleaseBufferMips(ALBuf);
+
             switch(format)
             {
                 case AL_FORMAT_MONO8:
@@ -1082,6 +1087,140 @@ static void LoadData(ALbuffer *ALBuf, const ALubyte *data, ALsizei size, ALuint
 }
 
 
+static void ReleaseBufferMips(ALbuffer *ALBuf)
+{
+    ALuint i;
+
+    for(i = 0;i < BUFFER_MIP_LEVELS;i++)
+    {
+        free(ALBuf->mipdata[i]);
+        ALBuf->mipdata[i] = NULL;
+    }
+}
+
+/*
+*    GetBufferMipFrames(ALbuffer *ALBuf, ALuint level)
+*
+*    INTERNAL FN : Returns the number of sample frames at the given mip level,
+*    where level 0 is the buffer's own data and each level halves the rate
+*/
+ALsizei GetBufferMipFrames(ALbuffer *ALBuf, ALuint level)
+{
+    ALsizei frames;
+
+    frames  = ALBuf->size;
+    frames /= aluChannelsFromFormat(ALBuf->format) * aluBytesFromFormat(ALBuf->format);
+    return (frames + (1<<level) - 1) >> level;
+}
+
+/*
+*    GenerateBufferMips(ALbuffer *ALBuf)
+*
+*    INTERNAL FN : Generates the decimated copies of the buffer's data that it
+*    doesn't have yet, for sources played back at high pitch to read fewer
+*    samples from without aliasing. Each level is low-pass filtered with a
+*    half-band FIR before being decimated from the level above it, and like the
+*    buffer data is padded with 8 extra zeroed sample frames.
+*
+*    Must be called with the context suspended. The lock is dropped while the
+*    levels are filtered, so a long buffer doesn't hold up the mixer, and the
+*    buffer is kept referenced meanwhile so its data can't be replaced or
+*    deleted. Returns AL_FALSE if memory ran out; the levels made before then
+*    are kept, and the mixer reads from the last one there is.
+*/
+ALboolean GenerateBufferMips(ALbuffer *ALBuf)
+{
+    ALshort *levels[BUFFER_MIP_LEVELS];
+    const ALshort *src;
+    ALshort *dst;
+    ALsizei frames, outframes;
+    ALsizei i, n;
+    ALuint c, channels, level;
+    ALboolean ret = AL_TRUE;
+
+    if(!ALBuf->data || ALBuf->mipdata[BUFFER_MIP_LEVELS-1])
+        return AL_TRUE;
+
+    ALBuf->refcount++;
+    ProcessContext(NULL);
+
+    channels = aluChannelsFromFormat(ALBuf->format);
+    src = ALBuf->data;
+    for(level = 1;level <= BUFFER_MIP_LEVELS;level++)
+    {
+        levels[level-1] = NULL;
+        if(ALBuf->mipdata[level-1])
+        {
+            src = ALBuf->mipdata[level-1];
+            continue;
+        }
+        if(!ret)
+            continue;
+
+        frames    = GetBufferMipFrames(ALBuf, level-1);
+        outframes = GetBufferMipFrames(ALBuf, level);
+
+        dst = calloc((outframes+8) * channels, sizeof(ALshort));
+        if(!dst)
+        {
+            AL_PRINT("Could not allocate buffer mip level %u\n", level);
+            ret = AL_FALSE;
+            continue;
+        }
+
+#define MIP_SRC(x) (((x) >= 0 && (x) < frames) ? (ALint)src[(x)*channels + c] : 0)
+        for(n = 0;n < outframes;n++)
+        {
+            i = n*2;
+            for(c = 0;c < channels;c++)
+            {
+                // Half-band taps: -1 0 9 16 9 0 -1 (/32)
+                ALint smp = 16*MIP_SRC(i) +
+                            9*(MIP_SRC(i-1) + MIP_SRC(i+1)) -
+                            (MIP_SRC(i-3) + MIP_SRC(i+3));
+                smp /= 32;
+                smp = min(smp,  32767);
+                smp = max(smp, -32768);
+                dst[n*channels + c] = (ALshort)smp;
+            }
+        }
+#undef MIP_SRC
+
+        levels[level-1] = dst;
+        src = dst;
+    }
+
+    SuspendContext(NULL);
+    ALBuf->refcount--;
+
+    // Another thread may have made the same levels while the lock was dropped
+    for(level = 0;level < BUFFER_MIP_LEVELS;level++)
+    {
+        if(!levels[level])
+            continue;
+        if(!ALBuf->mipdata[level])
+            ALBuf->mipdata[level] = levels[level];
+        else
+            free(levels[level]);
+    }
+    return ret;
+}
+
+/*
+*    GetBufferMipData(ALbuffer *ALBuf, ALuint level)
+*
+*    INTERNAL FN : Returns the sample data for the given mip level, where level
+*    0 is the buffer's own data. Returns NULL if the level wasn't generated.
+*/
+ALshort *GetBufferMipData(ALbuffer *ALBuf, ALuint level)
+{
+    if(level == 0)
+        return ALBuf->data;
+    if(level > BUFFER_MIP_LEVELS)
+        return NULL;
+    return ALBuf->mipdata[level-1];
+}
+
 /*
 *    ReleaseALBuffers()
 *
@@ -1102,6 +1241,7 @@ ALvoid ReleaseALBuffers(ALvoid)
     {
         // Release sample data
         free(ALBuffer->data);
+        ReleaseBufferMips(ALBuffer);
 
         // Release Buffer structure
         ALBufferTemp = ALBuffer;
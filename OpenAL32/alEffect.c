@@ -166,7 +166,10 @@ AL_API ALvoid AL_APIENTRY alEffecti(ALuint effect, ALenum param, ALint iValue)
         if(param == AL_EFFECT_TYPE)
         {
             if(iValue == AL_EFFECT_NULL ||
-               iValue == AL_EFFECT_REVERB)
+               iValue == AL_EFFECT_REVERB ||
+               iValue == AL_EFFECT_ECHO ||
+               iValue == AL_EFFECT_COMPRESSOR ||
+               iValue == AL_EFFECT_EQUALIZER)
                 InitEffectParams(ALEffect, iValue);
             else
                 alSetError(AL_INVALID_VALUE);
@@ -187,6 +190,22 @@ AL_API ALvoid AL_APIENTRY alEffecti(ALuint effect, ALenum param, ALint iValue)
                 break;
             }
         }
+        else if(ALEffect->type == AL_EFFECT_COMPRESSOR)
+        {
+            switch(param)
+            {
+            case AL_COMPRESSOR_ONOFF:
+                if(iValue == AL_TRUE || iValue == AL_FALSE)
+                    ALEffect->Compressor.OnOff = iValue;
+                else
+                    alSetError(AL_INVALID_VALUE);
+                break;
+
+            default:
+                alSetError(AL_INVALID_ENUM);
+                break;
+            }
+        }
         else
             alSetError(AL_INVALID_ENUM);
     }
@@ -224,6 +243,19 @@ AL_API ALvoid AL_APIENTRY alEffectiv(ALuint effect, ALenum param, ALint *piValue
                 break;
             }
         }
+        else if(ALEffect->type == AL_EFFECT_COMPRESSOR)
+        {
+            switch(param)
+            {
+            case AL_COMPRESSOR_ONOFF:
+                alEffecti(effect, param, piValues[0]);
+                break;
+
+            default:
+                alSetError(AL_INVALID_ENUM);
+                break;
+            }
+        }
         else
             alSetError(AL_INVALID_ENUM);
     }
@@ -298,7 +330,7 @@ AL_API ALvoid AL_APIENTRY alEffectf(ALuint effect, ALenum param, ALfloat flValue
                 break;
 
             case AL_REVERB_REFLECTIONS_DELAY:
-                if(flValue >= 0.0f && flValue <= 0.3f)
+                if(flValue >= 0.0f && flValue <= AL_REVERB_MAX_REFLECTIONS_DELAY)
                     ALEffect->Reverb.ReflectionsDelay = flValue;
                 else
                     alSetError(AL_INVALID_VALUE);
@@ -312,7 +344,7 @@ AL_API ALvoid AL_APIENTRY alEffectf(ALuint effect, ALenum param, ALfloat flValue
                 break;
 
             case AL_REVERB_LATE_REVERB_DELAY:
-                if(flValue >= 0.0f && flValue <= 0.1f)
+                if(flValue >= 0.0f && flValue <= AL_REVERB_MAX_LATE_REVERB_DELAY)
                     ALEffect->Reverb.LateReverbDelay = flValue;
                 else
                     alSetError(AL_INVALID_VALUE);
@@ -337,6 +369,129 @@ AL_API ALvoid AL_APIENTRY alEffectf(ALuint effect, ALenum param, ALfloat flValue
                 break;
             }
         }
+        else if(ALEffect->type == AL_EFFECT_ECHO)
+        {
+            switch(param)
+            {
+            case AL_ECHO_DELAY:
+                if(flValue >= 0.0f && flValue <= AL_ECHO_MAX_DELAY)
+                    ALEffect->Echo.Delay = flValue;
+                else
+                    alSetError(AL_INVALID_VALUE);
+                break;
+
+            case AL_ECHO_LRDELAY:
+                if(flValue >= 0.0f && flValue <= AL_ECHO_MAX_LRDELAY)
+                    ALEffect->Echo.LRDelay = flValue;
+                else
+                    alSetError(AL_INVALID_VALUE);
+                break;
+
+            case AL_ECHO_DAMPING:
+                if(flValue >= 0.0f && flValue <= 0.99f)
+                    ALEffect->Echo.Damping = flValue;
+                else
+                    alSetError(AL_INVALID_VALUE);
+                break;
+
+            case AL_ECHO_FEEDBACK:
+                if(flValue >= 0.0f && flValue <= 1.0f)
+                    ALEffect->Echo.Feedback = flValue;
+                else
+                    alSetError(AL_INVALID_VALUE);
+                break;
+
+            case AL_ECHO_SPREAD:
+                if(flValue >= -1.0f && flValue <= 1.0f)
+                    ALEffect->Echo.Spread = flValue;
+                else
+                    alSetError(AL_INVALID_VALUE);
+                break;
+
+            default:
+                alSetError(AL_INVALID_ENUM);
+                break;
+            }
+        }
+        else if(ALEffect->type == AL_EFFECT_EQUALIZER)
+        {
+            switch(param)
+            {
+            case AL_EQUALIZER_LOW_GAIN:
+                if(flValue >= 0.126f && flValue <= 7.943f)
+                    ALEffect->Equalizer.LowGain = flValue;
+                else
+                    alSetError(AL_INVALID_VALUE);
+                break;
+
+            case AL_EQUALIZER_LOW_CUTOFF:
+                if(flValue >= 50.0f && flValue <= 800.0f)
+                    ALEffect->Equalizer.LowCutoff = flValue;
+                else
+                    alSetError(AL_INVALID_VALUE);
+                break;
+
+            case AL_EQUALIZER_MID1_GAIN:
+                if(flValue >= 0.126f && flValue <= 7.943f)
+                    ALEffect->Equalizer.Mid1Gain = flValue;
+                else
+                    alSetError(AL_INVALID_VALUE);
+                break;
+
+            case AL_EQUALIZER_MID1_CENTER:
+                if(flValue >= 200.0f && flValue <= 3000.0f)
+                    ALEffect->Equalizer.Mid1Center = flValue;
+                else
+                    alSetError(AL_INVALID_VALUE);
+                break;
+
+            case AL_EQUALIZER_MID1_WIDTH:
+                if(flValue >= 0.01f && flValue <= 1.0f)
+                    ALEffect->Equalizer.Mid1Width = flValue;
+                else
+                    alSetError(AL_INVALID_VALUE);
+                break;
+
+            case AL_EQUALIZER_MID2_GAIN:
+                if(flValue >= 0.126f && flValue <= 7.943f)
+                    ALEffect->Equalizer.Mid2Gain = flValue;
+                else
+                    alSetError(AL_INVALID_VALUE);
+                break;
+
+            case AL_EQUALIZER_MID2_CENTER:
+                if(flValue >= 1000.0f && flValue <= 8000.0f)
+                    ALEffect->Equalizer.Mid2Center = flValue;
+                else
+                    alSetError(AL_INVALID_VALUE);
+                break;
+
+            case AL_EQUALIZER_MID2_WIDTH:
+                if(flValue >= 0.01f && flValue <= 1.0f)
+                    ALEffect->Equalizer.Mid2Width = flValue;
+                else
+                    alSetError(AL_INVALID_VALUE);
+                break;
+
+            case AL_EQUALIZER_HIGH_GAIN:
+                if(flValue >= 0.126f && flValue <= 7.943f)
+                    ALEffect->Equalizer.HighGain = flValue;
+                else
+                    alSetError(AL_INVALID_VALUE);
+                break;
+
+            case AL_EQUALIZER_HIGH_CUTOFF:
+                if(flValue >= 4000.0f && flValue <= 16000.0f)
+                    ALEffect->Equalizer.HighCutoff = flValue;
+                else
+                    alSetError(AL_INVALID_VALUE);
+                break;
+
+            default:
+                alSetError(AL_INVALID_ENUM);
+                break;
+            }
+        }
         else
             alSetError(AL_INVALID_ENUM);
     }
@@ -381,6 +536,45 @@ AL_API ALvoid AL_APIENTRY alEffectfv(ALuint effect, ALenum param, ALfloat *pflVa
                 break;
             }
         }
+        else if(ALEffect->type == AL_EFFECT_ECHO)
+        {
+            switch(param)
+            {
+            case AL_ECHO_DELAY:
+            case AL_ECHO_LRDELAY:
+            case AL_ECHO_DAMPING:
+            case AL_ECHO_FEEDBACK:
+            case AL_ECHO_SPREAD:
+                alEffectf(effect, param, pflValues[0]);
+                break;
+
+            default:
+                alSetError(AL_INVALID_ENUM);
+                break;
+            }
+        }
+        else if(ALEffect->type == AL_EFFECT_EQUALIZER)
+        {
+            switch(param)
+            {
+            case AL_EQUALIZER_LOW_GAIN:
+            case AL_EQUALIZER_LOW_CUTOFF:
+            case AL_EQUALIZER_MID1_GAIN:
+            case AL_EQUALIZER_MID1_CENTER:
+            case AL_EQUALIZER_MID1_WIDTH:
+            case AL_EQUALIZER_MID2_GAIN:
+            case AL_EQUALIZER_MID2_CENTER:
+            case AL_EQUALIZER_MID2_WIDTH:
+            case AL_EQUALIZER_HIGH_GAIN:
+            case AL_EQUALIZER_HIGH_CUTOFF:
+                alEffectf(effect, param, pflValues[0]);
+                break;
+
+            default:
+                alSetError(AL_INVALID_ENUM);
+                break;
+            }
+        }
         else
             alSetError(AL_INVALID_ENUM);
     }
@@ -418,6 +612,19 @@ AL_API ALvoid AL_APIENTRY alGetEffecti(ALuint effect, ALenum param, ALint *piVal
                 break;
             }
         }
+        else if(ALEffect->type == AL_EFFECT_COMPRESSOR)
+        {
+            switch(param)
+            {
+            case AL_COMPRESSOR_ONOFF:
+                *piValue = ALEffect->Compressor.OnOff;
+                break;
+
+            default:
+                alSetError(AL_INVALID_ENUM);
+                break;
+            }
+        }
         else
             alSetError(AL_INVALID_ENUM);
     }
@@ -455,6 +662,19 @@ AL_API ALvoid AL_APIENTRY alGetEffectiv(ALuint effect, ALenum param, ALint *piVa
                 break;
             }
         }
+        else if(ALEffect->type == AL_EFFECT_COMPRESSOR)
+        {
+            switch(param)
+            {
+            case AL_COMPRESSOR_ONOFF:
+                alGetEffecti(effect, param, piValues);
+                break;
+
+            default:
+                alSetError(AL_INVALID_ENUM);
+                break;
+            }
+        }
         else
             alSetError(AL_INVALID_ENUM);
     }
@@ -532,6 +752,84 @@ AL_API ALvoid AL_APIENTRY alGetEffectf(ALuint effect, ALenum param, ALfloat *pfl
                 break;
             }
         }
+        else if(ALEffect->type == AL_EFFECT_ECHO)
+        {
+            switch(param)
+            {
+            case AL_ECHO_DELAY:
+                *pflValue = ALEffect->Echo.Delay;
+                break;
+
+            case AL_ECHO_LRDELAY:
+                *pflValue = ALEffect->Echo.LRDelay;
+                break;
+
+            case AL_ECHO_DAMPING:
+                *pflValue = ALEffect->Echo.Damping;
+                break;
+
+            case AL_ECHO_FEEDBACK:
+                *pflValue = ALEffect->Echo.Feedback;
+                break;
+
+            case AL_ECHO_SPREAD:
+                *pflValue = ALEffect->Echo.Spread;
+                break;
+
+            default:
+                alSetError(AL_INVALID_ENUM);
+                break;
+            }
+        }
+        else if(ALEffect->type == AL_EFFECT_EQUALIZER)
+        {
+            switch(param)
+            {
+            case AL_EQUALIZER_LOW_GAIN:
+                *pflValue = ALEffect->Equalizer.LowGain;
+                break;
+
+            case AL_EQUALIZER_LOW_CUTOFF:
+                *pflValue = ALEffect->Equalizer.LowCutoff;
+                break;
+
+            case AL_EQUALIZER_MID1_GAIN:
+                *pflValue = ALEffect->Equalizer.Mid1Gain;
+                break;
+
+            case AL_EQUALIZER_MID1_CENTER:
+                *pflValue = ALEffect->Equalizer.Mid1Center;
+                break;
+
+            case AL_EQUALIZER_MID1_WIDTH:
+                *pflValue = ALEffect->Equalizer.Mid1Width;
+                break;
+
+            case AL_EQUALIZER_MID2_GAIN:
+                *pflValue = ALEffect->Equalizer.Mid2Gain;
+                break;
+
+            case AL_EQUALIZER_MID2_CENTER:
+                *pflValue = ALEffect->Equalizer.Mid2Center;
+                break;
+
+            case AL_EQUALIZER_MID2_WIDTH:
+                *pflValue = ALEffect->Equalizer.Mid2Width;
+                break;
+
+            case AL_EQUALIZER_HIGH_GAIN:
+                *pflValue = ALEffect->Equalizer.HighGain;
+                break;
+
+            case AL_EQUALIZER_HIGH_CUTOFF:
+                *pflValue = ALEffect->Equalizer.HighCutoff;
+                break;
+
+            default:
+                alSetError(AL_INVALID_ENUM);
+                break;
+            }
+        }
         else
             alSetError(AL_INVALID_ENUM);
     }
@@ -576,6 +874,45 @@ AL_API ALvoid AL_APIENTRY alGetEffectfv(ALuint effect, ALenum param, ALfloat *pf
                 break;
             }
         }
+        else if(ALEffect->type == AL_EFFECT_ECHO)
+        {
+            switch(param)
+            {
+            case AL_ECHO_DELAY:
+            case AL_ECHO_LRDELAY:
+            case AL_ECHO_DAMPING:
+            case AL_ECHO_FEEDBACK:
+            case AL_ECHO_SPREAD:
+                alGetEffectf(effect, param, pflValues);
+                break;
+
+            default:
+                alSetError(AL_INVALID_ENUM);
+                break;
+            }
+        }
+        else if(ALEffect->type == AL_EFFECT_EQUALIZER)
+        {
+            switch(param)
+            {
+            case AL_EQUALIZER_LOW_GAIN:
+            case AL_EQUALIZER_LOW_CUTOFF:
+            case AL_EQUALIZER_MID1_GAIN:
+            case AL_EQUALIZER_MID1_CENTER:
+            case AL_EQUALIZER_MID1_WIDTH:
+            case AL_EQUALIZER_MID2_GAIN:
+            case AL_EQUALIZER_MID2_CENTER:
+            case AL_EQUALIZER_MID2_WIDTH:
+            case AL_EQUALIZER_HIGH_GAIN:
+            case AL_EQUALIZER_HIGH_CUTOFF:
+                alGetEffectf(effect, param, pflValues);
+                break;
+
+            default:
+                alSetError(AL_INVALID_ENUM);
+                break;
+            }
+        }
         else
             alSetError(AL_INVALID_ENUM);
     }
@@ -626,5 +963,27 @@ static void InitEffectParams(ALeffect *effect, ALenum type)
         effect->Reverb.RoomRolloffFactor = 0.0f;
         effect->Reverb.DecayHFLimit = AL_TRUE;
         break;
+    case AL_EFFECT_ECHO:
+        effect->Echo.Delay = 0.1f;
+        effect->Echo.LRDelay = 0.1f;
+        effect->Echo.Damping = 0.5f;
+        effect->Echo.Feedback = 0.5f;
+        effect->Echo.Spread = -1.0f;
+        break;
+    case AL_EFFECT_COMPRESSOR:
+        effect->Compressor.OnOff = AL_TRUE;
+        break;
+    case AL_EFFECT_EQUALIZER:
+        effect->Equalizer.LowGain = 1.0f;
+        effect->Equalizer.LowCutoff = 200.0f;
+        effect->Equalizer.Mid1Gain = 1.0f;
+        effect->Equalizer.Mid1Center = 500.0f;
+        effect->Equalizer.Mid1Width = 1.0f;
+        effect->Equalizer.Mid2Gain = 1.0f;
+        effect->Equalizer.Mid2Center = 3000.0f;
+        effect->Equalizer.Mid2Width = 1.0f;
+        effect->Equalizer.HighGain = 1.0f;
+        effect->Equalizer.HighCutoff = 6000.0f;
+        break;
     }
 }
@@ -190,6 +190,9 @@ static ALenums enumeration[]={
     { (ALchar *)"AL_AUXILIARY_SEND_FILTER_GAIN_AUTO",   AL_AUXILIARY_SEND_FILTER_GAIN_AUTO  },
     { (ALchar *)"AL_AUXILIARY_SEND_FILTER_GAINHF_AUTO", AL_AUXILIARY_SEND_FILTER_GAINHF_AUTO},
 
+    // Source Priority
+    { (ALchar *)"AL_SOURCE_PRIORITY_SOFT",              AL_SOURCE_PRIORITY_SOFT             },
+
 
     // Source State information
     { (ALchar *)"AL_SOURCE_STATE",                      AL_SOURCE_STATE                     },
@@ -310,6 +313,28 @@ static ALenums enumeration[]={
     { (ALchar *)"AL_REVERB_ROOM_ROLLOFF_FACTOR",        AL_REVERB_ROOM_ROLLOFF_FACTOR       },
     { (ALchar *)"AL_REVERB_DECAY_HFLIMIT",              AL_REVERB_DECAY_HFLIMIT             },
 
+    // Echo params
+    { (ALchar *)"AL_ECHO_DELAY",                        AL_ECHO_DELAY                       },
+    { (ALchar *)"AL_ECHO_LRDELAY",                      AL_ECHO_LRDELAY                     },
+    { (ALchar *)"AL_ECHO_DAMPING",                      AL_ECHO_DAMPING                     },
+    { (ALchar *)"AL_ECHO_FEEDBACK",                     AL_ECHO_FEEDBACK                    },
+    { (ALchar *)"AL_ECHO_SPREAD",                       AL_ECHO_SPREAD                      },
+
+    // Compressor params
+    { (ALchar *)"AL_COMPRESSOR_ONOFF",                  AL_COMPRESSOR_ONOFF                 },
+
+    // Equalizer params
+    { (ALchar *)"AL_EQUALIZER_LOW_GAIN",                AL_EQUALIZER_LOW_GAIN               },
+    { (ALchar *)"AL_EQUALIZER_LOW_CUTOFF",              AL_EQUALIZER_LOW_CUTOFF             },
+    { (ALchar *)"AL_EQUALIZER_MID1_GAIN",               AL_EQUALIZER_MID1_GAIN              },
+    { (ALchar *)"AL_EQUALIZER_MID1_CENTER",             AL_EQUALIZER_MID1_CENTER            },
+    { (ALchar *)"AL_EQUALIZER_MID1_WIDTH",              AL_EQUALIZER_MID1_WIDTH             },
+    { (ALchar *)"AL_EQUALIZER_MID2_GAIN",               AL_EQUALIZER_MID2_GAIN              },
+    { (ALchar *)"AL_EQUALIZER_MID2_CENTER",             AL_EQUALIZER_MID2_CENTER            },
+    { (ALchar *)"AL_EQUALIZER_MID2_WIDTH",              AL_EQUALIZER_MID2_WIDTH             },
+    { (ALchar *)"AL_EQUALIZER_HIGH_GAIN",               AL_EQUALIZER_HIGH_GAIN              },
+    { (ALchar *)"AL_EQUALIZER_HIGH_CUTOFF",             AL_EQUALIZER_HIGH_CUTOFF            },
+
 
     // Default
     { (ALchar *)NULL,                                   (ALenum)0                           }
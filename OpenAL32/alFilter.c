@@ -167,7 +167,9 @@ AL_API ALvoid AL_APIENTRY alFilteri(ALuint filter, ALenum param, ALint iValue)
         {
         case AL_FILTER_TYPE:
             if(iValue == AL_FILTER_NULL ||
-               iValue == AL_FILTER_LOWPASS)
+               iValue == AL_FILTER_LOWPASS ||
+               iValue == AL_FILTER_HIGHPASS ||
+               iValue == AL_FILTER_BANDPASS)
                 InitFilterParams(ALFilter, iValue);
             else
                 alSetError(AL_INVALID_VALUE);
@@ -220,33 +222,41 @@ AL_API ALvoid AL_APIENTRY alFilterf(ALuint filter, ALenum param, ALfloat flValue
     if (filter && alIsFilter(filter))
     {
         ALfilter *ALFilter = (ALfilter*)ALTHUNK_LOOKUPENTRY(filter);
+        ALfloat *pGain = NULL;
 
-        switch(param)
+        // The parameters of each filter type share values
+        switch(ALFilter->type)
         {
-        case AL_LOWPASS_GAIN:
-            if(ALFilter->type == AL_FILTER_LOWPASS)
-            {
-                if(flValue >= 0.0f && flValue <= 1.0f)
-                    ALFilter->Gain = flValue;
-            }
-            else
-                alSetError(AL_INVALID_ENUM);
+        case AL_FILTER_LOWPASS:
+            if(param == AL_LOWPASS_GAIN)
+                pGain = &ALFilter->Gain;
+            else if(param == AL_LOWPASS_GAINHF)
+                pGain = &ALFilter->GainHF;
             break;
 
-        case AL_LOWPASS_GAINHF:
-            if(ALFilter->type == AL_FILTER_LOWPASS)
-            {
-                if(flValue >= 0.0f && flValue <= 1.0f)
-                    ALFilter->GainHF = flValue;
-            }
-            else
-                alSetError(AL_INVALID_ENUM);
+        case AL_FILTER_HIGHPASS:
+            if(param == AL_HIGHPASS_GAIN)
+                pGain = &ALFilter->Gain;
+            else if(param == AL_HIGHPASS_GAINLF)
+                pGain = &ALFilter->GainLF;
             break;
 
-        default:
-            alSetError(AL_INVALID_ENUM);
+        case AL_FILTER_BANDPASS:
+            if(param == AL_BANDPASS_GAIN)
+                pGain = &ALFilter->Gain;
+            else if(param == AL_BANDPASS_GAINLF)
+                pGain = &ALFilter->GainLF;
+            else if(param == AL_BANDPASS_GAINHF)
+                pGain = &ALFilter->GainHF;
             break;
         }
+
+        if(!pGain)
+            alSetError(AL_INVALID_ENUM);
+        else if(flValue >= 0.0f && flValue <= 1.0f)
+            *pGain = flValue;
+        else
+            alSetError(AL_INVALID_VALUE);
     }
     else
         alSetError(AL_INVALID_NAME);
@@ -267,6 +277,7 @@ AL_API ALvoid AL_APIENTRY alFilterfv(ALuint filter, ALenum param, ALfloat *pflVa
         {
         case AL_LOWPASS_GAIN:
         case AL_LOWPASS_GAINHF:
+        case AL_BANDPASS_GAINHF:
             alFilterf(filter, param, pflValues[0]);
             break;
 
@@ -339,27 +350,38 @@ AL_API ALvoid AL_APIENTRY alGetFilterf(ALuint filter, ALenum param, ALfloat *pfl
     if (filter && alIsFilter(filter))
     {
         ALfilter *ALFilter = (ALfilter*)ALTHUNK_LOOKUPENTRY(filter);
+        ALfloat *pGain = NULL;
 
-        switch(param)
+        switch(ALFilter->type)
         {
-        case AL_LOWPASS_GAIN:
-            if(ALFilter->type == AL_FILTER_LOWPASS)
-                *pflValue = ALFilter->Gain;
-            else
-                alSetError(AL_INVALID_ENUM);
+        case AL_FILTER_LOWPASS:
+            if(param == AL_LOWPASS_GAIN)
+                pGain = &ALFilter->Gain;
+            else if(param == AL_LOWPASS_GAINHF)
+                pGain = &ALFilter->GainHF;
             break;
 
-        case AL_LOWPASS_GAINHF:
-            if(ALFilter->type == AL_FILTER_LOWPASS)
-                *pflValue = ALFilter->GainHF;
-            else
-                alSetError(AL_INVALID_ENUM);
+        case AL_FILTER_HIGHPASS:
+            if(param == AL_HIGHPASS_GAIN)
+                pGain = &ALFilter->Gain;
+            else if(param == AL_HIGHPASS_GAINLF)
+                pGain = &ALFilter->GainLF;
             break;
 
-        default:
-            alSetError(AL_INVALID_ENUM);
+        case AL_FILTER_BANDPASS:
+            if(param == AL_BANDPASS_GAIN)
+                pGain = &ALFilter->Gain;
+            else if(param == AL_BANDPASS_GAINLF)
+                pGain = &ALFilter->GainLF;
+            else if(param == AL_BANDPASS_GAINHF)
+                pGain = &ALFilter->GainHF;
             break;
         }
+
+        if(pGain)
+            *pflValue = *pGain;
+        else
+            alSetError(AL_INVALID_ENUM);
     }
     else
         alSetError(AL_INVALID_NAME);
@@ -380,6 +402,7 @@ AL_API ALvoid AL_APIENTRY alGetFilterfv(ALuint filter, ALenum param, ALfloat *pf
         {
         case AL_LOWPASS_GAIN:
         case AL_LOWPASS_GAINHF:
+        case AL_BANDPASS_GAINHF:
             alGetFilterf(filter, param, pflValues);
             break;
 
@@ -421,4 +444,5 @@ static void InitFilterParams(ALfilter *filter, ALenum type)
 
     filter->Gain = 1.0;
     filter->GainHF = 1.0;
+    filter->GainLF = 1.0;
 }
@@ -24,6 +24,7 @@
 #include "AL/alc.h"
 #include "alError.h"
 #include "alListener.h"
+#include "alSource.h"
 
 ALAPI ALvoid ALAPIENTRY alListenerf(ALenum eParam, ALfloat flValue)
 {
@@ -38,7 +39,10 @@ ALAPI ALvoid ALAPIENTRY alListenerf(ALenum eParam, ALfloat flValue)
         {
         case AL_GAIN:
             if (flValue >= 0.0f)
+            {
                 pContext->Listener.Gain = flValue;
+                RefreshSourceGrid(pContext);
+            }
             else
                 alSetError(AL_INVALID_VALUE);
             break;
@@ -116,7 +120,10 @@ ALAPI ALvoid ALAPIENTRY alListenerfv(ALenum eParam, const ALfloat *pflValues)
             {
             case AL_GAIN:
                 if (pflValues[0] >= 0.0f)
+                {
                     pContext->Listener.Gain = pflValues[0];
+                    RefreshSourceGrid(pContext);
+                }
                 else
                     alSetError(AL_INVALID_VALUE);
                 break;
@@ -36,6 +36,9 @@ static ALvoid InitSourceParams(ALsource *pSource);
 static ALboolean GetSourceOffset(ALsource *pSource, ALenum eName, ALfloat *pflOffset);
 static ALvoid ApplyOffset(ALsource *pSource, ALboolean bUpdateContext);
 static ALint GetByteOffset(ALsource *pSource);
+static ALvoid RemoveFromGrid(ALCcontext *Context, ALsource *pSource);
+static ALboolean ReserveVoiceList(ALCcontext *Context, ALuint count);
+static ALvoid PrepareSourceMips(ALCcontext *Context, ALuint source);
 
 ALAPI ALvoid ALAPIENTRY alGenSources(ALsizei n,ALuint *sources)
 {
@@ -64,25 +67,32 @@ ALAPI ALvoid ALAPIENTRY alGenSources(ALsizei n,ALuint *sources)
                         while(*list)
                             list = &(*list)->next;
 
-                        // Add additional sources to the list (Source->next points to the location for the next Source structure)
-                        while(i < n)
+                        // Make room to rank every source under the voice
+                        // limit now, so the mixer never has to allocate
+                        if(!ReserveVoiceList(Context, Context->SourceCount + n))
+                            alSetError(AL_OUT_OF_MEMORY);
+                        else
                         {
-                            *list = calloc(1, sizeof(ALsource));
-                            if(!(*list))
+                            // Add additional sources to the list (Source->next points to the location for the next Source structure)
+                            while(i < n)
                             {
-                                alDeleteSources(i, sources);
-                                alSetError(AL_OUT_OF_MEMORY);
-                                break;
-                            }
+                                *list = calloc(1, sizeof(ALsource));
+                                if(!(*list))
+                                {
+                                    alDeleteSources(i, sources);
+                                    alSetError(AL_OUT_OF_MEMORY);
+                                    break;
+                                }
 
-                            sources[i] = (ALuint)ALTHUNK_ADDENTRY(*list);
-                            (*list)->source = sources[i];
+                                sources[i] = (ALuint)ALTHUNK_ADDENTRY(*list);
+                                (*list)->source = sources[i];
 
-                            InitSourceParams(*list);
-                            Context->SourceCount++;
-                            i++;
+                                InitSourceParams(*list);
+                                Context->SourceCount++;
+                                i++;
 
-                            list = &(*list)->next;
+                                list = &(*list)->next;
+                            }
                         }
                     }
                     else
@@ -181,6 +191,9 @@ ALAPI ALvoid ALAPIENTRY alDeleteSources(ALsizei n, const ALuint *sources)
                                     ALSource->Send[j].Slot = NULL;
                                 }
 
+                                if(ALSource->InGrid)
+                                    RemoveFromGrid(Context, ALSource);
+
                                 // Decrement Source count
                                 Context->SourceCount--;
 
@@ -292,14 +305,20 @@ ALAPI ALvoid ALAPIENTRY alSourcef(ALuint source, ALenum eParam, ALfloat flValue)
 
             case AL_CONE_INNER_ANGLE:
                 if ((flValue >= 0.0f) && (flValue <= 360.0f))
+                {
                     pSource->flInnerAngle = flValue;
+                    pSource->CosInnerAngle = aluConeAngleCos(flValue);
+                }
                 else
                     alSetError(AL_INVALID_VALUE);
                 break;
 
             case AL_CONE_OUTER_ANGLE:
                 if ((flValue >= 0.0f) && (flValue <= 360.0f))
+                {
                     pSource->flOuterAngle = flValue;
+                    pSource->CosOuterAngle = aluConeAngleCos(flValue);
+                }
                 else
                     alSetError(AL_INVALID_VALUE);
                 break;
@@ -398,6 +417,11 @@ ALAPI ALvoid ALAPIENTRY alSourcef(ALuint source, ALenum eParam, ALfloat flValue)
                 alSetError(AL_INVALID_ENUM);
                 break;
             }
+
+            if(pContext->SourceGrid)
+                UpdateSourceGrid(pContext, pSource);
+            if(eParam == AL_PITCH)
+                PrepareSourceMips(pContext, source);
         }
         else
         {
@@ -454,6 +478,9 @@ ALAPI ALvoid ALAPIENTRY alSource3f(ALuint source, ALenum eParam, ALfloat flValue
                 alSetError(AL_INVALID_ENUM);
                 break;
             }
+
+            if(pContext->SourceGrid)
+                UpdateSourceGrid(pContext, pSource);
         }
         else
             alSetError(AL_INVALID_NAME);
@@ -552,6 +579,8 @@ ALAPI ALvoid ALAPIENTRY alSourcei(ALuint source,ALenum eParam,ALint lValue)
             case AL_MAX_DISTANCE:
             case AL_ROLLOFF_FACTOR:
             case AL_REFERENCE_DISTANCE:
+            case AL_CONE_INNER_ANGLE:
+            case AL_CONE_OUTER_ANGLE:
                 alSourcef(source, eParam, (ALfloat)lValue);
                 break;
 
@@ -562,20 +591,6 @@ ALAPI ALvoid ALAPIENTRY alSourcei(ALuint source,ALenum eParam,ALint lValue)
                     alSetError(AL_INVALID_VALUE);
                 break;
 
-            case AL_CONE_INNER_ANGLE:
-                if ((lValue >= 0) && (lValue <= 360))
-                    pSource->flInnerAngle = (float)lValue;
-                else
-                    alSetError(AL_INVALID_VALUE);
-                break;
-
-            case AL_CONE_OUTER_ANGLE:
-                if ((lValue >= 0) && (lValue <= 360))
-                    pSource->flOuterAngle = (float)lValue;
-                else
-                    alSetError(AL_INVALID_VALUE);
-                break;
-
             case AL_LOOPING:
                 if ((lValue == AL_FALSE) || (lValue == AL_TRUE))
                     pSource->bLooping = (ALboolean)lValue;
@@ -709,10 +724,17 @@ ALAPI ALvoid ALAPIENTRY alSourcei(ALuint source,ALenum eParam,ALint lValue)
                     alSetError(AL_INVALID_VALUE);
                 break;
 
+            case AL_SOURCE_PRIORITY_SOFT:
+                pSource->Priority = lValue;
+                break;
+
             default:
                 alSetError(AL_INVALID_ENUM);
                 break;
             }
+
+            if(pContext->SourceGrid)
+                UpdateSourceGrid(pContext, pSource);
         }
         else
             alSetError(AL_INVALID_NAME);
@@ -748,7 +770,7 @@ ALAPI void ALAPIENTRY alSource3i(ALuint source, ALenum eParam, ALint lValue1, AL
                 break;
 
             case AL_AUXILIARY_SEND_FILTER:
-                if(lValue2 >= 0 && lValue2 < MAX_SENDS &&
+                if(lValue2 >= 0 && lValue2 < (ALint)pContext->Device->NumAuxSends &&
                    (alIsAuxiliaryEffectSlot(lValue1) || lValue1 == 0) &&
                    alIsFilter(lValue3))
                 {
@@ -780,6 +802,9 @@ ALAPI void ALAPIENTRY alSource3i(ALuint source, ALenum eParam, ALint lValue1, AL
                 alSetError(AL_INVALID_ENUM);
                 break;
             }
+
+            if(pContext->SourceGrid)
+                UpdateSourceGrid(pContext, pSource);
         }
         else
             alSetError(AL_INVALID_NAME);
@@ -824,6 +849,7 @@ ALAPI void ALAPIENTRY alSourceiv(ALuint source, ALenum eParam, const ALint* plVa
                 case AL_DIRECT_FILTER_GAINHF_AUTO:
                 case AL_AUXILIARY_SEND_FILTER_GAIN_AUTO:
                 case AL_AUXILIARY_SEND_FILTER_GAINHF_AUTO:
+                case AL_SOURCE_PRIORITY_SOFT:
                     alSourcei(source, eParam, plValues[0]);
                     break;
 
@@ -1184,6 +1210,10 @@ ALAPI ALvoid ALAPIENTRY alGetSourcei(ALuint source, ALenum eParam, ALint *plValu
                     *plValue = pSource->WetGainHFAuto;
                     break;
 
+                case AL_SOURCE_PRIORITY_SOFT:
+                    *plValue = pSource->Priority;
+                    break;
+
                 default:
                     alSetError(AL_INVALID_ENUM);
                     break;
@@ -1297,6 +1327,7 @@ ALAPI void ALAPIENTRY alGetSourceiv(ALuint source, ALenum eParam, ALint* plValue
                 case AL_DIRECT_FILTER_GAINHF_AUTO:
                 case AL_AUXILIARY_SEND_FILTER_GAIN_AUTO:
                 case AL_AUXILIARY_SEND_FILTER_GAINHF_AUTO:
+                case AL_SOURCE_PRIORITY_SOFT:
                     alGetSourcei(source, eParam, plValues);
                     break;
 
@@ -1440,6 +1471,9 @@ ALAPI ALvoid ALAPIENTRY alSourcePlayv(ALsizei n, const ALuint *pSourceList)
                         pSource->BuffersPlayed = pSource->BuffersProcessed = pSource->BuffersInQueue;
                     }
                 }
+
+                for (i = 0; i < n; i++)
+                    PrepareSourceMips(pContext, pSourceList[i]);
             }
         }
         else
@@ -1813,6 +1847,8 @@ ALAPI ALvoid ALAPIENTRY alSourceQueueBuffers( ALuint source, ALsizei n, const AL
 
                     // Update number of buffers in queue
                     ALSource->BuffersInQueue += n;
+
+                    PrepareSourceMips(Context, source);
                 }
             }
             else
@@ -1955,6 +1991,8 @@ static ALvoid InitSourceParams(ALsource *pSource)
 {
     pSource->flInnerAngle = 360.0f;
     pSource->flOuterAngle = 360.0f;
+    pSource->CosInnerAngle = aluConeAngleCos(360.0f);
+    pSource->CosOuterAngle = aluConeAngleCos(360.0f);
     pSource->flPitch = 1.0f;
     pSource->vPosition[0] = 0.0f;
     pSource->vPosition[1] = 0.0f;
@@ -2284,6 +2322,218 @@ static ALint GetByteOffset(ALsource *pSource)
 }
 
 
+/*
+    CalcCullRadius
+
+    Returns the distance from the listener beyond which the source's dry path
+    is guaranteed to fall under the context's cull gain, or a negative value
+    if no such distance exists (e.g. the distance model never attenuates far
+    enough, or the source feeds an effect slot).
+*/
+static ALfloat CalcCullRadius(ALCcontext *Context, ALsource *pSource)
+{
+    ALfloat MinDist = pSource->flRefDistance;
+    ALfloat MaxDist = pSource->flMaxDistance;
+    ALfloat Rolloff = pSource->flRollOffFactor;
+    ALfloat Gain, Atten, Radius;
+    ALboolean Clamped = AL_FALSE;
+    ALsizei i;
+
+    if(pSource->bHeadRelative)
+        return -1.0f;
+    for(i = 0;i < MAX_SENDS;i++)
+    {
+        if(pSource->Send[i].Slot)
+            return -1.0f;
+    }
+    // The dry send gains of all output channels add up to at most twice the
+    // source's attenuated gain, which never drops below its min gain
+    if(pSource->flMinGain * Context->Listener.Gain * 2.0f >= Context->VoiceCullGain)
+        return -1.0f;
+
+    Gain = pSource->flGain * Context->Listener.Gain * 2.0f;
+    if(Gain <= Context->VoiceCullGain)
+        return 0.0f;
+    Atten = Context->VoiceCullGain / Gain;
+
+    switch(Context->DistanceModel)
+    {
+        case AL_INVERSE_DISTANCE_CLAMPED:
+            Clamped = AL_TRUE;
+            //fall-through
+        case AL_INVERSE_DISTANCE:
+            if(MinDist <= 0.0f || Rolloff <= 0.0f)
+                return -1.0f;
+            Radius = MinDist + (MinDist/Atten - MinDist)/Rolloff;
+            break;
+
+        case AL_LINEAR_DISTANCE_CLAMPED:
+        case AL_LINEAR_DISTANCE:
+            // Linear models always clamp to the max distance
+            Clamped = AL_TRUE;
+            if(MaxDist == MinDist || Rolloff <= 0.0f)
+                return -1.0f;
+            Radius = MinDist + (1.0f-Atten)*(MaxDist-MinDist)/Rolloff;
+            break;
+
+        case AL_EXPONENT_DISTANCE_CLAMPED:
+            Clamped = AL_TRUE;
+            //fall-through
+        case AL_EXPONENT_DISTANCE:
+            if(MinDist <= 0.0f || Rolloff <= 0.0f)
+                return -1.0f;
+            Radius = MinDist * (ALfloat)pow(Atten, -1.0f/Rolloff);
+            break;
+
+        default:
+            return -1.0f;
+    }
+
+    if(Clamped && (MaxDist < MinDist || Radius > MaxDist))
+        return -1.0f;
+    return Radius;
+}
+
+ALint GetGridCoord(ALfloat pos, ALfloat CellSize)
+{
+    ALfloat cell = (ALfloat)floor(pos / CellSize);
+    if(cell >  1073741823.0f) return  1073741823;
+    if(cell < -1073741823.0f) return -1073741823;
+    return (ALint)cell;
+}
+
+static ALvoid RemoveFromGrid(ALCcontext *Context, ALsource *pSource)
+{
+    ALsource **list = &Context->SourceGrid[GRID_HASH(pSource->GridCell[0],
+                                                     pSource->GridCell[1],
+                                                     pSource->GridCell[2])];
+    while(*list && *list != pSource)
+        list = &(*list)->GridNext;
+    if(*list)
+        *list = pSource->GridNext;
+    pSource->GridNext = NULL;
+    pSource->InGrid = AL_FALSE;
+
+    if(pSource->CullRadius >= Context->GridMaxRadius)
+        Context->GridMaxDirty = AL_TRUE;
+}
+
+/*
+    UpdateSourceGrid
+
+    Re-evaluates the source's cull radius and moves it to the grid cell for
+    its current position. Sources without a finite cull radius are kept out
+    of the grid, and are always processed by the mixer.
+*/
+ALvoid UpdateSourceGrid(ALCcontext *Context, ALsource *pSource)
+{
+    ALfloat OldRadius = pSource->CullRadius;
+    ALfloat Radius;
+    ALint Cell[3];
+
+    Radius = CalcCullRadius(Context, pSource);
+    Cell[0] = GetGridCoord(pSource->vPosition[0], Context->GridCellSize);
+    Cell[1] = GetGridCoord(pSource->vPosition[1], Context->GridCellSize);
+    Cell[2] = GetGridCoord(pSource->vPosition[2], Context->GridCellSize);
+
+    if(pSource->InGrid && (Radius < 0.0f ||
+                           Cell[0] != pSource->GridCell[0] ||
+                           Cell[1] != pSource->GridCell[1] ||
+                           Cell[2] != pSource->GridCell[2]))
+        RemoveFromGrid(Context, pSource);
+
+    pSource->CullRadius = Radius;
+    if(Radius < 0.0f)
+        return;
+
+    if(!pSource->InGrid)
+    {
+        ALuint hash = GRID_HASH(Cell[0], Cell[1], Cell[2]);
+        memcpy(pSource->GridCell, Cell, sizeof(Cell));
+        pSource->GridNext = Context->SourceGrid[hash];
+        Context->SourceGrid[hash] = pSource;
+        pSource->InGrid = AL_TRUE;
+    }
+    else if(Radius < OldRadius && OldRadius >= Context->GridMaxRadius)
+        Context->GridMaxDirty = AL_TRUE;
+
+    if(Radius > Context->GridMaxRadius)
+        Context->GridMaxRadius = Radius;
+}
+
+/*
+    RefreshSourceGrid
+
+    Re-evaluates every source's cull radius after a context-wide change
+    (distance model, listener gain)
+*/
+ALvoid RefreshSourceGrid(ALCcontext *Context)
+{
+    ALsource *pSource;
+
+    if(!Context->SourceGrid)
+        return;
+
+    for(pSource = Context->Source;pSource;pSource = pSource->next)
+        UpdateSourceGrid(Context, pSource);
+}
+
+
+/*
+    PrepareSourceMips
+
+    Generates the mip levels of the buffers in the source's queue that it
+    plays back at above twice their rate, so the mixer only ever looks them
+    up. Doppler shifts aren't known until the mixer runs, so a source pushed
+    over by one alone plays from the full-rate data. The lock is dropped while
+    each buffer's levels are made, so the source is looked up again after
+    every one.
+*/
+static ALvoid PrepareSourceMips(ALCcontext *Context, ALuint source)
+{
+    ALsource *pSource;
+    ALbufferlistitem *ALBufferList;
+    ALbuffer *ALBuffer = NULL;
+
+    while(alIsSource(source))
+    {
+        pSource = (ALsource*)ALTHUNK_LOOKUPENTRY(source);
+        for(ALBufferList = pSource->queue;ALBufferList;ALBufferList = ALBufferList->next)
+        {
+            if(!ALBufferList->buffer)
+                continue;
+            ALBuffer = (ALbuffer*)ALTHUNK_LOOKUPENTRY(ALBufferList->buffer);
+            if(ALBuffer->data && !ALBuffer->mipdata[BUFFER_MIP_LEVELS-1] &&
+               pSource->flPitch*ALBuffer->frequency > 2.0f*Context->Frequency)
+                break;
+        }
+        if(!ALBufferList || !GenerateBufferMips(ALBuffer))
+            break;
+    }
+}
+
+/*
+    ReserveVoiceList
+
+    Grows the context's voice list to hold at least count sources. The voice
+    limit ranks every playing source in it, and is applied by the mixer, which
+    must not allocate.
+*/
+static ALboolean ReserveVoiceList(ALCcontext *Context, ALuint count)
+{
+    void *temp;
+
+    if(count <= Context->VoiceListSize)
+        return AL_TRUE;
+
+    temp = realloc(Context->VoiceList, count*sizeof(ALsource*));
+    if(!temp)
+        return AL_FALSE;
+    Context->VoiceList = temp;
+    Context->VoiceListSize = count;
+    return AL_TRUE;
+}
+
 ALvoid ReleaseALSources(ALCcontext *Context)
 {
 #ifdef _DEBUG
@@ -25,6 +25,7 @@
 #include "AL/alc.h"
 #include "alError.h"
 #include "alState.h"
+#include "alSource.h"
 
 static const ALchar alVendor[] = "OpenAL Community";
 static const ALchar alVersion[] = "1.1";
@@ -660,6 +661,7 @@ ALAPI ALvoid ALAPIENTRY alDistanceModel(ALenum value)
             case AL_EXPONENT_DISTANCE:
             case AL_EXPONENT_DISTANCE_CLAMPED:
                 Context->DistanceModel = value;
+                RefreshSourceGrid(Context);
                 break;
 
             default:
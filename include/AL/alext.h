@@ -62,6 +62,23 @@ extern "C" {
 #define AL_FORMAT_STEREO_IMA4                    0x1301
 #endif
 
+#ifndef AL_SOFTX_source_priority
+#define AL_SOFTX_source_priority 1
+/* Source property; when the device's voice limit is reached, sources with a
+ * higher priority are mixed first. The value is from a block kept for this
+ * library's own enums, clear of the core AL and EFX ranges. */
+#define AL_SOURCE_PRIORITY_SOFT                  0xC000
+#endif
+
+#ifndef ALC_EXT_capture_stats
+#define ALC_EXT_capture_stats 1
+/* Frames captured but not yet returned by alcCaptureSamples, including those
+ * still buffered by the device */
+#define ALC_CAPTURE_LATENCY_EXT                  0x20010
+/* Number of times captured audio was lost because it wasn't read in time */
+#define ALC_CAPTURE_OVERRUNS_EXT                 0x20011
+#endif
+
 #ifdef __cplusplus
 }
 #endif
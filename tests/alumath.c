@@ -0,0 +1,166 @@
+/**
+ * OpenAL cross platform audio library
+ * Copyright (C) 1999-2007 by authors.
+ * This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ *  License along with this library; if not, write to the
+ *  Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ *  Boston, MA  02111-1307, USA.
+ * Or go to http://www.gnu.org/copyleft/lgpl.html
+ */
+
+/* Checks the mixer's approximations in alu.h against the exact math they
+ * replaced: table panning against sqrt, aluFastPow against pow, and the
+ * cosine cone test against classifying and interpolating on the acos of the
+ * angle. Each check fails when its largest error passes the stated bound. */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <math.h>
+
+#include "alu.h"
+
+#define PI 3.14159265358979323846
+
+/* Absolute error of one panning gain, and of a two-axis product */
+#define PAN_ERROR_BOUND      0.006
+#define PAN2D_ERROR_BOUND    0.012
+/* Relative error of aluFastPow, for results in [1e-30, 1e30] */
+#define POW_ERROR_BOUND      5e-5
+/* Absolute difference in the cone scale (0 inside to 1 outside) from the
+ * double precision acos path; float cosines near 1 limit it for narrow
+ * cones */
+#define CONE_ERROR_BOUND     1e-3
+
+ALfloat aluPanTable[PANTABLE_SIZE+1];
+
+static double MaxError(double error, double value)
+{
+    return ((value > error) ? value : error);
+}
+
+static int Check(const char *name, double error, double bound)
+{
+    printf("%-24s max error %.3g (bound %.3g)\n", name, error, bound);
+    if(error > bound)
+    {
+        printf("%s: FAILED\n", name);
+        return 1;
+    }
+    return 0;
+}
+
+static double PanError(void)
+{
+    double error = 0.0;
+    int i;
+
+    for(i = 0;i <= 100000;i++)
+    {
+        double x = i / 100000.0;
+        error = MaxError(error, fabs(aluPanGain((ALfloat)x) - sqrt(x)));
+    }
+    return error;
+}
+
+static double Pan2DError(void)
+{
+    double error = 0.0;
+    int i, j;
+
+    // four points per table step, to land on the worst spots near 0
+    for(i = 0;i <= PANTABLE_SIZE*4;i++)
+    {
+        double lr = (double)i / (PANTABLE_SIZE*4);
+        for(j = 0;j <= PANTABLE_SIZE*4;j++)
+        {
+            double fb = (double)j / (PANTABLE_SIZE*4);
+            double approx = aluPanGain((ALfloat)lr) * aluPanGain((ALfloat)fb);
+            error = MaxError(error, fabs(approx - sqrt(lr*fb)));
+        }
+    }
+    return error;
+}
+
+static double PowError(void)
+{
+    double error = 0.0;
+    int i, j;
+
+    for(i = 0;i <= 2000;i++)
+    {
+        // distance ratios and absorption bases from 1e-3 to 1e4
+        double x = pow(10.0, -3.0 + 7.0*i/2000.0);
+        for(j = 0;j <= 200;j++)
+        {
+            double y = -10.0 + 20.0*j/200.0;
+            double exact = pow(x, y);
+
+            if(exact < 1e-30 || exact > 1e30)
+                continue;
+            error = MaxError(error, fabs(aluFastPow((ALfloat)x, (ALfloat)y) - exact) / exact);
+        }
+    }
+    return error;
+}
+
+/* The cone scale as it was computed before the cosine test */
+static double AngleConeScale(double CosAngle, double InnerAngle, double OuterAngle)
+{
+    double Angle = acos(CosAngle) * 180.0 / PI;
+
+    if(Angle >= InnerAngle && Angle <= OuterAngle)
+        return (Angle-InnerAngle) / (OuterAngle-InnerAngle);
+    if(Angle > OuterAngle)
+        return 1.0;
+    return 0.0;
+}
+
+static double ConeError(void)
+{
+    double error = 0.0;
+    int inner, outer, i;
+
+    for(inner = 0;inner <= 360;inner += 5)
+    {
+        ALfloat CosInner = aluConeAngleCos((ALfloat)inner);
+        for(outer = 0;outer <= 360;outer += 5)
+        {
+            ALfloat CosOuter = aluConeAngleCos((ALfloat)outer);
+            // sample between the cone edges, where the scale steps when
+            // the outer cone isn't wider than the inner one
+            for(i = 0;i < 1800;i++)
+            {
+                double CosAngle = cos((i+0.5) * PI / 1800.0);
+                double approx = aluConeScale((ALfloat)CosAngle, CosInner, CosOuter,
+                                             (ALfloat)inner, (ALfloat)outer);
+                error = MaxError(error, fabs(approx - AngleConeScale(CosAngle, inner, outer)));
+            }
+        }
+    }
+    return error;
+}
+
+int main(void)
+{
+    int failed = 0;
+
+    aluInitPanning();
+
+    failed += Check("panning", PanError(), PAN_ERROR_BOUND);
+    failed += Check("two-axis panning", Pan2DError(), PAN2D_ERROR_BOUND);
+    failed += Check("aluFastPow", PowError(), POW_ERROR_BOUND);
+    failed += Check("cone scale", ConeError(), CONE_ERROR_BOUND);
+
+    return (failed ? 1 : 0);
+}
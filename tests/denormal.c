@@ -0,0 +1,363 @@
+/**
+ * OpenAL cross platform audio library
+ * Copyright (C) 1999-2007 by authors.
+ * This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ *  License along with this library; if not, write to the
+ *  Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ *  Boston, MA  02111-1307, USA.
+ * Or go to http://www.gnu.org/copyleft/lgpl.html
+ */
+
+/* Checks that the mixer's recursive filters settle to exact zeros on a long
+ * silent tail, instead of decaying through denormals. A biquad (mono and
+ * four channels interleaved), the reverb and the bs2b crossfeed are each fed
+ * a burst of noise followed by silence, one mixer-sized block at a time.
+ * Their histories must never hold a denormal after a block, and must reach
+ * exactly 0.0f before the tail ends. This runs once with the FPU as the app
+ * left it, and once with flush-to-zero set the way aluMixData sets it.
+ *
+ * The cost of the tail's blocks is also compared, since that is what
+ * denormals hurt. It's timed in windows of blocks, and the slowest window
+ * may not take more than TIME_RATIO_BOUND times the fastest one. */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "alMain.h"
+#include "alFilter.h"
+#include "bs2b.h"
+
+/* The reverb's state is private to it, so it's built in here */
+#include "../Alc/alcReverb.c"
+
+#if defined(HAVE_XMMINTRIN_H) && (defined(__SSE__) || defined(_M_X64) || \
+                                   (defined(_M_IX86_FP) && _M_IX86_FP >= 1))
+#include <xmmintrin.h>
+#define HAVE_SSE_CSR
+#if defined(__x86_64__) || defined(_M_X64)
+#define SSE_CSR_FLUSH (0x8000 | 0x0040)
+#else
+#define SSE_CSR_FLUSH (0x8000)
+#endif
+#endif
+
+#define FREQUENCY     44100
+#define BLOCK         256
+#define BURST_BLOCKS  4
+/* 30 seconds of silence; the reverb below rings for about 12 */
+#define TAIL_BLOCKS   5200
+#define TIME_WINDOW   400
+
+#define TIME_RATIO_BOUND 10.0
+
+#define PI 3.14159265358979323846
+
+
+/* Denormals are told apart by their bits, since with denormals-are-zero set
+ * they would compare equal to zero */
+static int IsDenormal(ALfloat value)
+{
+    ALuint bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return ((bits&0x7f800000) == 0 && (bits&0x007fffff) != 0);
+}
+
+static int IsZero(ALfloat value)
+{
+    ALuint bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return ((bits&0x7fffffff) == 0);
+}
+
+/* Noise at the mixer's 16-bit scale for the burst, silence after it */
+static ALuint Seed;
+static ALvoid FillInput(ALfloat *data, ALuint count, ALuint block)
+{
+    ALuint i;
+
+    for(i = 0;i < count;i++)
+    {
+        data[i] = 0.0f;
+        if(block < BURST_BLOCKS)
+        {
+            Seed = Seed*1664525 + 1013904223;
+            data[i] = (ALfloat)((ALint)(Seed>>16) - 32768);
+        }
+    }
+}
+
+
+typedef struct Tail {
+    const char *name;
+    // Block of the tail after which the state was all zeros, or -1
+    int zeroed;
+    int failed;
+
+    clock_t window[TAIL_BLOCKS/TIME_WINDOW];
+    clock_t start;
+} Tail;
+
+static ALvoid InitTail(Tail *tail, const char *name)
+{
+    memset(tail, 0, sizeof(*tail));
+    tail->name = name;
+    tail->zeroed = -1;
+}
+
+static ALvoid StartBlock(Tail *tail)
+{
+    tail->start = clock();
+}
+
+/* Records a block of the tail, given whether any history held a denormal or
+ * anything but zero after it */
+static ALvoid EndBlock(Tail *tail, ALuint block, int denormal, int nonzero)
+{
+    ALuint tb = block - BURST_BLOCKS;
+
+    if(block < BURST_BLOCKS)
+        return;
+    if(tb/TIME_WINDOW < TAIL_BLOCKS/TIME_WINDOW)
+        tail->window[tb/TIME_WINDOW] += clock() - tail->start;
+
+    if(denormal && !tail->failed)
+    {
+        printf("%s: denormal history after tail block %u\n", tail->name, tb);
+        tail->failed = 1;
+    }
+    if(nonzero)
+        tail->zeroed = -1;
+    else if(tail->zeroed < 0)
+        tail->zeroed = (int)tb;
+}
+
+static int CheckTail(Tail *tail)
+{
+    clock_t fast, slow;
+    ALuint w;
+
+    fast = slow = tail->window[0];
+    for(w = 1;w < TAIL_BLOCKS/TIME_WINDOW;w++)
+    {
+        if(tail->window[w] < fast) fast = tail->window[w];
+        if(tail->window[w] > slow) slow = tail->window[w];
+    }
+    // Windows too fast for the clock to see can't show anything
+    if(fast < 1)
+        fast = 1;
+
+    printf("%-22s zero after block %d, slowest/fastest window %.2f\n",
+           tail->name, tail->zeroed, (double)slow / (double)fast);
+    if(tail->zeroed < 0)
+    {
+        printf("%s: history never reached zero\n", tail->name);
+        tail->failed = 1;
+    }
+    if((double)slow / (double)fast > TIME_RATIO_BOUND)
+    {
+        printf("%s: block cost not flat\n", tail->name);
+        tail->failed = 1;
+    }
+    if(tail->failed)
+        printf("%s: FAILED\n", tail->name);
+    return tail->failed;
+}
+
+
+/* Resonant lowpass at 5khz (Q = 2), so the tail rings for a while */
+static ALvoid InitLowpass(ALbiquad *f)
+{
+    double w0 = 2.0*PI * 5000.0 / FREQUENCY;
+    double alpha = sin(w0) / (2.0*2.0);
+    double a0 = 1.0 + alpha;
+
+    f->b0 = (ALfloat)((1.0-cos(w0))/2.0 / a0);
+    f->b1 = (ALfloat)((1.0-cos(w0)) / a0);
+    f->b2 = f->b0;
+    f->a1 = (ALfloat)(-2.0*cos(w0) / a0);
+    f->a2 = (ALfloat)((1.0-alpha) / a0);
+}
+
+static int TestBiquad(const char *name, ALuint channels)
+{
+    ALfloat data[BLOCK*OUTPUTCHANNELS];
+    ALfloat z1[OUTPUTCHANNELS], z2[OUTPUTCHANNELS];
+    ALbiquad f;
+    Tail tail;
+    ALuint block, c;
+    int denormal, nonzero;
+
+    InitTail(&tail, name);
+    InitLowpass(&f);
+    memset(z1, 0, sizeof(z1));
+    memset(z2, 0, sizeof(z2));
+
+    for(block = 0;block < BURST_BLOCKS+TAIL_BLOCKS;block++)
+    {
+        FillInput(data, BLOCK*channels, block);
+
+        StartBlock(&tail);
+        aluFilterBlock(&f, z1, z2, data, channels, channels, BLOCK);
+
+        denormal = nonzero = 0;
+        for(c = 0;c < channels;c++)
+        {
+            denormal |= IsDenormal(z1[c]) | IsDenormal(z2[c]);
+            nonzero |= !IsZero(z1[c]) | !IsZero(z2[c]);
+        }
+        EndBlock(&tail, block, denormal, nonzero);
+    }
+
+    return CheckTail(&tail);
+}
+
+static int TestReverb(ALvoid)
+{
+    static ALfloat out[BLOCK][OUTPUTCHANNELS];
+    ALfloat in[BLOCK];
+    ALeffectState *effect;
+    ALverbState *State;
+    ALeffect Effect;
+    Tail tail;
+    ALuint block, i;
+    int denormal, nonzero;
+
+    InitTail(&tail, "reverb");
+
+    // The generic reverb preset
+    memset(&Effect, 0, sizeof(Effect));
+    Effect.Reverb.Density = 1.0f;
+    Effect.Reverb.Diffusion = 1.0f;
+    Effect.Reverb.Gain = 0.32f;
+    Effect.Reverb.GainHF = 0.89f;
+    Effect.Reverb.DecayTime = 1.49f;
+    Effect.Reverb.DecayHFRatio = 0.83f;
+    Effect.Reverb.ReflectionsGain = 0.05f;
+    Effect.Reverb.ReflectionsDelay = 0.007f;
+    Effect.Reverb.LateReverbGain = 1.26f;
+    Effect.Reverb.LateReverbDelay = 0.011f;
+
+    effect = ReverbCreate(FREQUENCY);
+    if(!effect)
+    {
+        printf("reverb: could not create the state\n");
+        return 1;
+    }
+    State = (ALverbState*)effect;
+    ALEffect_Update(effect, FREQUENCY, &Effect);
+
+    for(block = 0;block < BURST_BLOCKS+TAIL_BLOCKS;block++)
+    {
+        FillInput(in, BLOCK, block);
+        memset(out, 0, sizeof(out));
+
+        StartBlock(&tail);
+        ALEffect_Process(effect, BLOCK, in, out);
+
+        denormal = nonzero = 0;
+        for(i = 0;i < LATE_LINES;i++)
+        {
+            denormal |= IsDenormal(State->LineLast[i]);
+            nonzero |= !IsZero(State->LineLast[i]);
+        }
+        for(i = 0;i < (State->LineMask+1)*LATE_LINES;i++)
+        {
+            denormal |= IsDenormal(State->Lines[i]);
+            nonzero |= !IsZero(State->Lines[i]);
+        }
+        EndBlock(&tail, block, denormal, nonzero);
+    }
+
+    for(i = 0;i <= State->DelayMask;i++)
+    {
+        if(!IsZero(State->Delay[i]))
+        {
+            printf("reverb: input delay line not silent\n");
+            tail.failed = 1;
+            break;
+        }
+    }
+
+    ALEffect_Destroy(effect);
+    return CheckTail(&tail);
+}
+
+static int TestBs2b(ALvoid)
+{
+    ALfloat left[BLOCK], right[BLOCK];
+    struct bs2b bs2b;
+    Tail tail;
+    ALuint block, c;
+    int denormal, nonzero;
+
+    InitTail(&tail, "bs2b");
+
+    memset(&bs2b, 0, sizeof(bs2b));
+    bs2b_set_srate(&bs2b, FREQUENCY);
+    bs2b_set_level(&bs2b, BS2B_DEFAULT_CLEVEL);
+
+    for(block = 0;block < BURST_BLOCKS+TAIL_BLOCKS;block++)
+    {
+        FillInput(left, BLOCK, block);
+        FillInput(right, BLOCK, block);
+
+        StartBlock(&tail);
+        bs2b_cross_feed_block(&bs2b, left, right, 1, BLOCK);
+
+        denormal = nonzero = 0;
+        for(c = 0;c < 2;c++)
+        {
+            denormal |= IsDenormal(bs2b.last_sample.lo[c]) |
+                        IsDenormal(bs2b.last_sample.hi[c]) |
+                        IsDenormal(bs2b.last_sample.asis[c]);
+            nonzero |= !IsZero(bs2b.last_sample.lo[c]) |
+                       !IsZero(bs2b.last_sample.hi[c]) |
+                       !IsZero(bs2b.last_sample.asis[c]);
+        }
+        EndBlock(&tail, block, denormal, nonzero);
+    }
+
+    return CheckTail(&tail);
+}
+
+static int RunTests(ALvoid)
+{
+    int failed = 0;
+
+    Seed = 22222;
+    failed += TestBiquad("biquad, 1 channel", 1);
+    failed += TestBiquad("biquad, 4 channels", 4);
+    failed += TestBiquad("biquad, 6 channels", 6);
+    failed += TestReverb();
+    failed += TestBs2b();
+    return failed;
+}
+
+int main(void)
+{
+    int failed;
+
+    printf("Without flush-to-zero:\n");
+    failed = RunTests();
+
+#ifdef HAVE_SSE_CSR
+    _mm_setcsr(_mm_getcsr() | SSE_CSR_FLUSH);
+    printf("With flush-to-zero:\n");
+    failed += RunTests();
+#endif
+
+    return (failed ? 1 : 0);
+}